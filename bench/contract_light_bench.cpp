@@ -0,0 +1,708 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+// Measures the per call overhead of the contract constructs on hot setters
+// and getters. The result is printed as CSV (default) or as JSON (--json).
+// With --sizes the object sizes of the contract guards are reported instead.
+// On Linux the retired instructions, branch misses and L1 instruction cache
+// misses per call are read from the performance counters, -1 if they are not
+// available. contract_light_bench_no_hints is the same benchmark compiled
+// with CONTRACT_LIGHT_NO_BRANCH_HINTS to compare the effect of the hot/cold
+// splitting of the failure handling. contract_light_bench_counters is
+// compiled with CONTRACT_LIGHT_COUNTERS to measure the cost of the per site
+// counters. contract_light_bench_sampling is compiled with
+// CONTRACT_LIGHT_SAMPLING and checks only one of --sample-rate N calls.
+// contract_light_bench_runtime_levels and contract_light_bench_static_keys
+// are compiled with CONTRACT_LIGHT_RUNTIME_LEVELS and
+// CONTRACT_LIGHT_STATIC_KEYS, --level 0 switches all contracts off at runtime.
+// The result benchmarks return a large object, without a contract, with a
+// postcondition on a named local and with POSTCONDITION_RESULT.
+//
+// Usage: contract_light_bench [--json] [--sizes] [--iterations N] [--repetitions N] [--sample-rate N] [--level N]
+
+#include "contract_light.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  /**
+   * Prevents that the compiler optimizes away the measured operation
+   */
+  template <typename T>
+  inline void doNotOptimize(T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    volatile auto sink = &value;
+    (void)sink;
+#endif
+  }
+
+  /**
+   * Returns the time stamp counter, or 0 on platforms without one
+   */
+  inline std::uint64_t readCycles() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * A single hardware performance counter of the calling thread. It is
+   * invalid if the platform or the permissions do not allow to read it.
+   */
+  class PerfCounter
+  {
+    int fd_;
+  public:
+    PerfCounter(std::uint32_t type, std::uint64_t config) : fd_(-1) {
+#if defined(__linux__)
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+      (void)type;
+      (void)config;
+#endif
+    }
+
+    ~PerfCounter() {
+#if defined(__linux__)
+      if (fd_ != -1) {
+        close(fd_);
+      }
+#endif
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    void start() {
+#if defined(__linux__)
+      if (fd_ != -1) {
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+      }
+#endif
+    }
+
+    /**
+     * Returns the counted events since start(), or -1 if the counter is invalid
+     */
+    std::int64_t stop() {
+#if defined(__linux__)
+      std::uint64_t value = 0;
+      if (fd_ != -1 && ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0) == 0 &&
+          read(fd_, &value, sizeof(value)) == sizeof(value)) {
+        return static_cast<std::int64_t>(value);
+      }
+#endif
+      return -1;
+    }
+  };
+
+  struct PerfCounters
+  {
+#if defined(__linux__)
+    PerfCounters()
+      : instructions(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS)
+      , branchMisses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES)
+      , icacheMisses(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1I |
+                                         (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+    {}
+#else
+    PerfCounters() : instructions(0, 0), branchMisses(0, 0), icacheMisses(0, 0) {}
+#endif
+
+    PerfCounter instructions;
+    PerfCounter branchMisses;
+    PerfCounter icacheMisses;
+  };
+
+  double perCall(std::int64_t events, std::size_t iterations) {
+    return events < 0 ? -1.0 : static_cast<double>(events) / iterations;
+  }
+
+#if defined(CONTRACT_LIGHT_NO_BRANCH_HINTS)
+  const int branchHints = 0;
+#else
+  const int branchHints = 1;
+#endif
+
+#if defined(CONTRACT_LIGHT_COUNTERS)
+  const int counters = 1;
+#else
+  const int counters = 0;
+#endif
+
+
+  class PlainRect
+  {
+    int w_;
+    int h_;
+  public:
+    PlainRect() : w_(0), h_(0) {}
+
+    void setWidth(int newW) { w_ = newW; }
+    void setHeight(int newH) { h_ = newH; }
+    void resize(int newW, int newH) { setWidth(newW); setHeight(newH); }
+    int area() const { return w_ * h_; }
+  };
+
+  class AssertRect
+  {
+    int w_;
+    int h_;
+  public:
+    AssertRect() : w_(0), h_(0) {}
+
+    void setWidth(int newW) {
+      assert(newW >= 0);
+      w_ = newW;
+      assert(w_ == newW && w_ >= 0 && h_ >= 0);
+    }
+
+    void setHeight(int newH) {
+      assert(newH >= 0);
+      h_ = newH;
+      assert(h_ == newH && w_ >= 0 && h_ >= 0);
+    }
+
+    void resize(int newW, int newH) {
+      assert(newW >= 0 && newH >= 0);
+      setWidth(newW);
+      setHeight(newH);
+      assert(w_ == newW && h_ == newH);
+    }
+
+    int area() const {
+      const int result = w_ * h_;
+      assert(result == w_ * h_);
+      return result;
+    }
+  };
+
+  class PreConditionRect
+  {
+    int w_;
+    int h_;
+  public:
+    PreConditionRect() : w_(0), h_(0) {}
+
+    void setWidth(int newW) {
+      PRECONDITION[&] { return newW >= 0; };
+      w_ = newW;
+    }
+
+    void setHeight(int newH) {
+      PRECONDITION[&] { return newH >= 0; };
+      h_ = newH;
+    }
+
+    void resize(int newW, int newH) {
+      PRECONDITION[&] { return newW >= 0 && newH >= 0; };
+      setWidth(newW);
+      setHeight(newH);
+    }
+
+    int area() const {
+      PRECONDITION[this] { return w_ >= 0 && h_ >= 0; };
+      return w_ * h_;
+    }
+  };
+
+  class PostConditionRect
+  {
+    int w_;
+    int h_;
+  public:
+    PostConditionRect() : w_(0), h_(0) {}
+
+    void setWidth(int newW) {
+      POSTCONDITION[&, this] { return w_ == newW; };
+      w_ = newW;
+    }
+
+    void setHeight(int newH) {
+      POSTCONDITION[&, this] { return h_ == newH; };
+      h_ = newH;
+    }
+
+    void resize(int newW, int newH) {
+      POSTCONDITION[&, this] { return w_ == newW && h_ == newH; };
+      setWidth(newW);
+      setHeight(newH);
+    }
+
+    int area() const {
+      int result;
+      POSTCONDITION[&, this] { return result == w_ * h_; };
+      result = w_ * h_;
+      return result;
+    }
+  };
+
+  class ContractRect
+  {
+    CONTRACTOR
+    int w_;
+    int h_;
+  public:
+    ContractRect() : w_(0), h_(0) {}
+
+    void setWidth(int newW) {
+      PRECONDITION[&] { return newW >= 0; };
+      POSTCONDITION[&, this] { return w_ == newW; };
+      w_ = newW;
+    }
+
+    void setHeight(int newH) {
+      PRECONDITION[&] { return newH >= 0; };
+      POSTCONDITION[&, this] { return h_ == newH; };
+      h_ = newH;
+    }
+
+    void resize(int newW, int newH) {
+      PRECONDITION[&] { return newW >= 0 && newH >= 0; };
+      POSTCONDITION[&, this] { return w_ == newW && h_ == newH; };
+      setWidth(newW);
+      setHeight(newH);
+    }
+
+    int area() const {
+      int result;
+      POSTCONDITION[&, this] { return result == w_ * h_; };
+      result = w_ * h_;
+      return result;
+    }
+
+    bool invariant() const {
+      return w_ >= 0 && h_ >= 0;
+    }
+  };
+
+
+  class CachedContractRect
+  {
+    CONTRACTOR_CACHED
+    int w_;
+    int h_;
+  public:
+    CachedContractRect() : w_(0), h_(0) {}
+
+    void setWidth(int newW) {
+      PRECONDITION[&] { return newW >= 0; };
+      POSTCONDITION[&, this] { return w_ == newW; };
+      w_ = newW;
+    }
+
+    void setHeight(int newH) {
+      PRECONDITION[&] { return newH >= 0; };
+      POSTCONDITION[&, this] { return h_ == newH; };
+      h_ = newH;
+    }
+
+    void resize(int newW, int newH) {
+      PRECONDITION[&] { return newW >= 0 && newH >= 0; };
+      POSTCONDITION[&, this] { return w_ == newW && h_ == newH; };
+      setWidth(newW);
+      setHeight(newH);
+    }
+
+    int area() const {
+      int result;
+      POSTCONDITION[&, this] { return result == w_ * h_; };
+      result = w_ * h_;
+      return result;
+    }
+
+    bool invariant() const {
+      return w_ >= 0 && h_ >= 0;
+    }
+  };
+
+
+  class ThreadLocalContractRect
+  {
+    CONTRACTOR_THREAD_LOCAL
+    int w_;
+    int h_;
+  public:
+    ThreadLocalContractRect() : w_(0), h_(0) {}
+
+    void setWidth(int newW) {
+      PRECONDITION[&] { return newW >= 0; };
+      POSTCONDITION[&, this] { return w_ == newW; };
+      w_ = newW;
+    }
+
+    void setHeight(int newH) {
+      PRECONDITION[&] { return newH >= 0; };
+      POSTCONDITION[&, this] { return h_ == newH; };
+      h_ = newH;
+    }
+
+    void resize(int newW, int newH) {
+      PRECONDITION[&] { return newW >= 0 && newH >= 0; };
+      POSTCONDITION[&, this] { return w_ == newW && h_ == newH; };
+      setWidth(newW);
+      setHeight(newH);
+    }
+
+    int area() const {
+      int result;
+      POSTCONDITION[&, this] { return result == w_ * h_; };
+      result = w_ * h_;
+      return result;
+    }
+
+    bool invariant() const {
+      return w_ >= 0 && h_ >= 0;
+    }
+  };
+
+
+  /**
+   * A return type that is expensive to copy and cannot be moved cheaply
+   */
+  struct LargeResult
+  {
+    LargeResult() {}
+    explicit LargeResult(int v) {
+      for (auto& x : values) {
+        x = v;
+      }
+    }
+
+    int values[256];
+  };
+
+  class PlainFactory
+  {
+  public:
+    LargeResult make(int v) const {
+      return LargeResult(v);
+    }
+  };
+
+  /**
+   * The pattern without result conditions: a default constructed local that
+   * is assigned and checked by a postcondition
+   */
+  class NamedResultFactory
+  {
+  public:
+    LargeResult make(int v) const {
+      LargeResult result;
+      POSTCONDITION[&] { return result.values[0] == v; };
+      result = LargeResult(v);
+      return result;
+    }
+  };
+
+  class ResultConditionFactory
+  {
+  public:
+    LargeResult make(int v) const {
+      POSTCONDITION_RESULT[&](const LargeResult& result) { return result.values[0] == v; };
+      RETURN_CHECKED(LargeResult(v));
+    }
+  };
+
+
+  template <typename Rect>
+  void benchSetter(std::size_t iterations) {
+    Rect r;
+    for (std::size_t i = 0; i < iterations; ++i) {
+      r.setWidth(static_cast<int>(i & 0xff));
+      doNotOptimize(r);
+    }
+  }
+
+  template <typename Rect>
+  void benchGetter(std::size_t iterations) {
+    Rect r;
+    r.resize(3, 4);
+    for (std::size_t i = 0; i < iterations; ++i) {
+      doNotOptimize(r);
+      auto a = r.area();
+      doNotOptimize(a);
+    }
+  }
+
+  template <typename Rect>
+  void benchNested(std::size_t iterations) {
+    Rect r;
+    for (std::size_t i = 0; i < iterations; ++i) {
+      r.resize(static_cast<int>(i & 0xff), static_cast<int>(i & 0x7f));
+      doNotOptimize(r);
+    }
+  }
+
+  template <typename Factory>
+  void benchResult(std::size_t iterations) {
+    Factory f;
+    for (std::size_t i = 0; i < iterations; ++i) {
+      auto r = f.make(static_cast<int>(i & 0xff));
+      doNotOptimize(r);
+    }
+  }
+
+  struct Benchmark
+  {
+    const char* name;
+    void(*run)(std::size_t);
+  };
+
+  struct Result
+  {
+    const char* name;
+    double nsPerCall;
+    double cyclesPerCall;
+    double instructionsPerCall;
+    double branchMissesPerCall;
+    double icacheMissesPerCall;
+  };
+
+  const Benchmark benchmarks[] = {
+    { "setter_plain", &benchSetter<PlainRect> },
+    { "setter_assert", &benchSetter<AssertRect> },
+    { "setter_precondition", &benchSetter<PreConditionRect> },
+    { "setter_postcondition", &benchSetter<PostConditionRect> },
+    { "setter_pre_post_invariant", &benchSetter<ContractRect> },
+    { "setter_pre_post_invariant_thread_local", &benchSetter<ThreadLocalContractRect> },
+    { "setter_pre_post_invariant_cached", &benchSetter<CachedContractRect> },
+    { "getter_plain", &benchGetter<PlainRect> },
+    { "getter_assert", &benchGetter<AssertRect> },
+    { "getter_precondition", &benchGetter<PreConditionRect> },
+    { "getter_postcondition", &benchGetter<PostConditionRect> },
+    { "getter_pre_post_invariant", &benchGetter<ContractRect> },
+    { "getter_pre_post_invariant_thread_local", &benchGetter<ThreadLocalContractRect> },
+    { "getter_pre_post_invariant_cached", &benchGetter<CachedContractRect> },
+    { "nested_plain", &benchNested<PlainRect> },
+    { "nested_assert", &benchNested<AssertRect> },
+    { "nested_precondition", &benchNested<PreConditionRect> },
+    { "nested_postcondition", &benchNested<PostConditionRect> },
+    { "nested_pre_post_invariant", &benchNested<ContractRect> },
+    { "nested_pre_post_invariant_thread_local", &benchNested<ThreadLocalContractRect> },
+    { "result_plain", &benchResult<PlainFactory> },
+    { "result_named_postcondition", &benchResult<NamedResultFactory> },
+    { "result_condition", &benchResult<ResultConditionFactory> },
+  };
+
+  /**
+   * Runs the benchmark several times and keeps the fastest run
+   */
+  Result measure(const Benchmark& b, std::size_t iterations, int repetitions) {
+    Result result = { b.name, 0.0, 0.0, -1.0, -1.0, -1.0 };
+    PerfCounters counters;
+    for (int r = 0; r < repetitions; ++r) {
+      const auto start = std::chrono::steady_clock::now();
+      const auto startCycles = readCycles();
+      counters.instructions.start();
+      counters.branchMisses.start();
+      counters.icacheMisses.start();
+      b.run(iterations);
+      const auto icacheMisses = counters.icacheMisses.stop();
+      const auto branchMisses = counters.branchMisses.stop();
+      const auto instructions = counters.instructions.stop();
+      const auto cycles = readCycles() - startCycles;
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+      const auto nsPerCall = static_cast<double>(ns) / iterations;
+      if (r == 0 || nsPerCall < result.nsPerCall) {
+        result.nsPerCall = nsPerCall;
+        result.cyclesPerCall = static_cast<double>(cycles) / iterations;
+        result.instructionsPerCall = perCall(instructions, iterations);
+        result.branchMissesPerCall = perCall(branchMisses, iterations);
+        result.icacheMissesPerCall = perCall(icacheMisses, iterations);
+      }
+    }
+    return result;
+  }
+
+  std::string compilerName() {
+#if defined(__clang__)
+    return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+  }
+
+  struct GuardSize
+  {
+    const char* name;
+    std::size_t bytes;
+  };
+
+  /**
+   * Sizes of the guards that the contract makros place on the stack. The
+   * predicate captures a single variable by reference.
+   */
+  std::vector<GuardSize> guardSizes() {
+    using namespace contract_light::contract_detail;
+    int x = 0;
+    auto op = [&x] { return x == 0; };
+    using Op = decltype(op);
+
+    return {
+      { "precondition", sizeof(PreCondition<PreConditionContext<PreConditionRect>, Op>) },
+      { "precondition_with_invariant", sizeof(PreCondition<PreConditionContext<ContractRect>, Op>) },
+      { "postcondition", sizeof(PostCondition<PostConditionContext<PostConditionRect>, Op>) },
+      { "postcondition_with_invariant", sizeof(PostCondition<PostConditionContext<ContractRect>, Op>) },
+      { "invariant", sizeof(Invariant<ContractContext<ContractRect>>) },
+      { "contractor", sizeof(contract_light::Contract) },
+      { "predicate", sizeof(Op) },
+    };
+  }
+
+  void printSizes(bool json) {
+    const auto sizes = guardSizes();
+    if (json) {
+      std::cout << "{\n  \"compiler\": \"" << compilerName() << "\",\n  \"guards\": [\n";
+      for (std::size_t i = 0; i < sizes.size(); ++i) {
+        std::cout << "    { \"name\": \"" << sizes[i].name << "\", \"bytes\": " << sizes[i].bytes << " }"
+                  << (i + 1 < sizes.size() ? ",\n" : "\n");
+      }
+      std::cout << "  ]\n}\n";
+    }
+    else {
+      std::cout << "guard,compiler,bytes\n";
+      for (const auto& g : sizes) {
+        std::cout << g.name << ",\"" << compilerName() << "\"," << g.bytes << "\n";
+      }
+    }
+  }
+
+  void printCsv(const std::vector<Result>& results, std::size_t iterations, std::uint32_t sampleRate) {
+    std::cout << "benchmark,compiler,level,branch_hints,counters,sample_rate,iterations,ns_per_call,cycles_per_call,"
+                 "instructions_per_call,branch_misses_per_call,icache_misses_per_call\n";
+    for (const auto& r : results) {
+      std::cout << r.name << ",\"" << compilerName() << "\"," << CONTRACT_LIGHT_LEVEL << ","
+                << branchHints << "," << counters << "," << sampleRate << "," << iterations << "," << r.nsPerCall << "," << r.cyclesPerCall << ","
+                << r.instructionsPerCall << "," << r.branchMissesPerCall << "," << r.icacheMissesPerCall << "\n";
+    }
+  }
+
+  void printJson(const std::vector<Result>& results, std::size_t iterations, std::uint32_t sampleRate) {
+    std::cout << "{\n  \"compiler\": \"" << compilerName() << "\",\n"
+              << "  \"level\": " << CONTRACT_LIGHT_LEVEL << ",\n"
+              << "  \"branch_hints\": " << branchHints << ",\n"
+              << "  \"counters\": " << counters << ",\n"
+              << "  \"sample_rate\": " << sampleRate << ",\n"
+              << "  \"iterations\": " << iterations << ",\n"
+              << "  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      std::cout << "    { \"name\": \"" << results[i].name << "\", "
+                << "\"ns_per_call\": " << results[i].nsPerCall << ", "
+                << "\"cycles_per_call\": " << results[i].cyclesPerCall << ", "
+                << "\"instructions_per_call\": " << results[i].instructionsPerCall << ", "
+                << "\"branch_misses_per_call\": " << results[i].branchMissesPerCall << ", "
+                << "\"icache_misses_per_call\": " << results[i].icacheMissesPerCall << " }"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    std::cout << "  ]\n}\n";
+  }
+}
+
+int main(int argc, char** argv) {
+  bool json = false;
+  bool sizes = false;
+  std::size_t iterations = 100000000;
+  int repetitions = 5;
+  std::uint32_t sampleRate = 1;
+  int level = CONTRACT_LIGHT_LEVEL_AUDIT;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0) {
+      json = true;
+    }
+    else if (std::strcmp(argv[i], "--sizes") == 0) {
+      sizes = true;
+    }
+    else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = std::strtoull(argv[++i], nullptr, 10);
+    }
+    else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+      repetitions = std::atoi(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--sample-rate") == 0 && i + 1 < argc) {
+      sampleRate = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    }
+    else if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+      level = std::atoi(argv[++i]);
+    }
+    else {
+      iterations = 0;
+      break;
+    }
+  }
+
+  if (iterations == 0 || repetitions < 1) {
+    std::cerr << "Usage: " << argv[0] << " [--json] [--sizes] [--iterations N] [--repetitions N] [--sample-rate N] [--level N]\n";
+    return 1;
+  }
+
+  if (sizes) {
+    printSizes(json);
+    return 0;
+  }
+
+  contract_light::setSampleRate(sampleRate);
+  contract_light::setContractLevel(level);
+
+  std::vector<Result> results;
+  for (const auto& b : benchmarks) {
+    results.push_back(measure(b, iterations, repetitions));
+  }
+
+  if (json) {
+    printJson(results, iterations, sampleRate);
+  }
+  else {
+    printCsv(results, iterations, sampleRate);
+  }
+  return 0;
+}
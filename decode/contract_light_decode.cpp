@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+// Prints the records of a violation log as text, one line per failed
+// contract with the time since the start of its session, the thread, the
+// kind, the site and the object, followed by its call stack. The frames are
+// symbolized with the ELF files of the mappings recorded in the session,
+// so it should run on the machine that wrote the log.
+//
+// Usage: contract_light_decode [--no-symbols] <log file>
+
+#include "contract_light.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char** argv) {
+  const bool symbolize = !(argc == 3 && std::strcmp(argv[1], "--no-symbols") == 0);
+  if (argc != (symbolize ? 2 : 3)) {
+    std::cerr << "Usage: " << argv[0] << " [--no-symbols] <log file>\n";
+    return 1;
+  }
+  const auto path = argv[argc - 1];
+  std::ifstream log(path, std::ios::binary);
+  if (!log) {
+    std::cerr << "Cannot open " << path << "\n";
+    return 1;
+  }
+  contract_light::decodeViolationLog(log, std::cout, symbolize);
+  return 0;
+}
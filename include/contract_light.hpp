@@ -10,10 +10,20 @@
 
 #pragma once
 
+#include "contract_light_config.hpp"
 #include "contract_light_helper.hpp"
 #include "contract_light_traits.hpp"
 #include "contract_light_context.hpp"
+#include "contract_light_site.hpp"
+#include "contract_light_audit.hpp"
+#include "contract_light_governor.hpp"
+#include "contract_light_deferred.hpp"
+#include "contract_light_log.hpp"
+#include "contract_light_old.hpp"
 
+#include <chrono>
+#include <cstdint>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -46,51 +56,402 @@ namespace contract_light
 
     /**
       * Set an alternate pre condition failed handler. The default version
-      * just prints the failure location to std::cout
+      * just prints the failure location to std::cout. It is called through an
+      * adapter of setViolationHandler.
       */
     void setHandlerFailedPreCondition(PreConditionFailedFunction) NOEXCEPT;
 
     /**
       * Set an alternate post condition failed handler. The default version
-      * just prints the failure location to std::cout
+      * just prints the failure location to std::cout. It is called through an
+      * adapter of setViolationHandler.
       * The function itself must not throw!
       */
     void setHandlerFailedPostCondition(PostConditionFailedFunction) NOEXCEPT;
 
     /**
       * Set an alternate invariant failed handler. The default version
-      * just prints the failure location to std::cout
+      * just prints the failure location to std::cout. It is called through an
+      * adapter of setViolationHandler.
       * The function itself must not throw!
       */
     void setHandlerFailedInvariant(InvariantFailedFunction) NOEXCEPT;
 
+    /**
+     * Everything that is known about a failed contract. It is only assembled
+     * on the failure path.
+     * @kind The kind of the failed contract. It differs from site->kind, if
+     *       the invariant failed at a pre- or postcondition.
+     * @site The static descriptor of the site with its level, expression,
+     *       function, file and line
+     * @object The address of the object whose contract failed. It is nullptr
+     *         for postconditions of classes without invariant and for
+     *         deferred checks, because their guards do not keep the object.
+     * @thread The thread that failed, for a deferred check the one that
+     *         captured it
+     * @ticks The cycle counter (rdtsc, clock_gettime as fallback) when the
+     *        failure was detected
+     * @frames The raw return addresses of the failing thread, starting in
+     *         the function with the failed contract. They live in a buffer
+     *         of the thread and are only valid during the call of the
+     *         handler.
+     * @frameCount The number of frames. It is 0 for deferred checks and if
+     *             the capture is switched off or not supported.
+     */
+    struct ViolationInfo
+    {
+      ContractKind kind;
+      const ContractSite* site;
+      const void* object;
+      std::thread::id thread;
+      std::uint64_t ticks;
+      const void* const* frames;
+      std::uint32_t frameCount;
+    };
+
+    /**
+     * Switches the capture of the call stack on failures on or off. It is on
+     * by default on platforms with _Unwind_Backtrace. Only the return
+     * addresses are captured, they can be symbolized offline, see
+     * startViolationLog.
+     */
+    void setViolationStackCapture(bool enabled) NOEXCEPT;
+
+    /**
+     * Function signature to handle failed contracts
+     */
+    using ViolationHandler = void(*)(const ViolationInfo& info);
+
+    /**
+     * Set the handler for the failed contracts of the given kind. It replaces
+     * a handler with the old signature and vice versa. Only the precondition
+     * handler may throw.
+     * @return The previous handler, so that it can be restored
+     */
+    ViolationHandler setViolationHandler(ContractKind kind, ViolationHandler) NOEXCEPT;
+
+    /**
+     * Function signature of a violation subscriber
+     * @kind The kind of the contract that failed
+     * @fileName The file where the contract was defined that failed
+     * @line The line number where the contract was defined that failed
+     * @userData The pointer that was passed on subscription
+     */
+    using ViolationSubscriber = void(*)(ContractKind kind, const char* fileName, int line, void* userData);
+
+    /**
+     * Adds a subscriber that gets called on every failed contract, before the
+     * handler of the contract kind is called. Any number of subscribers, e.g.
+     * for metrics and logging, can be added. It is safe to add and remove
+     * subscribers while other threads report failures, the reporting threads
+     * are never blocked. The function itself must not throw!
+     * @return The id of the subscription, needed for removal
+     */
+    int addViolationSubscriber(ViolationSubscriber, void* userData = nullptr);
+
+    /**
+     * Removes the subscriber with the given id. It may still be called by
+     * failures that are reported concurrently.
+     * @return false, if there is no subscriber with this id
+     */
+    bool removeViolationSubscriber(int id);
+
+    /**
+     * The failures of one site and kind that were not passed to the handler
+     * @kind The kind of the failed contract
+     * @site The site of the failed contract
+     * @suppressed The number of failures since the last summary
+     * @interval The time since the last summary
+     */
+    struct ViolationSummary
+    {
+      ContractKind kind;
+      const ContractSite* site;
+      std::uint64_t suppressed;
+      std::chrono::nanoseconds interval;
+    };
+
+    /**
+     * Function signature of the handler of the summaries. The default version
+     * prints the summary to std::cout. The function itself must not throw!
+     */
+    using ViolationSummaryHandler = void(*)(const ViolationSummary& summary);
+
+    /**
+     * Passes only the first failures of each site and kind to the handler.
+     * The later ones are just counted and reported as summary, at most once
+     * per interval, by the next failure of the site after the interval or
+     * else by a background thread that runs while a limit is set. So a
+     * suppressed failed precondition does not throw, even if its handler
+     * would. Subscribers still get every failure. A limit of 0, the default,
+     * passes all failures to the handler and stops the thread.
+     */
+    void setViolationReportLimit(std::uint32_t limit,
+                                 std::chrono::seconds interval = std::chrono::seconds(10)) NOEXCEPT;
+
+    void setViolationSummaryHandler(ViolationSummaryHandler) NOEXCEPT;
+
+    /**
+     * Reports the pending summaries of all sites, e.g. before the shutdown
+     */
+    void flushViolationSummaries() NOEXCEPT;
+
+    /**
+     * Forgets the failures of all sites, so their next failures are passed
+     * to the handler again. The pending summaries are dropped.
+     */
+    void resetViolationReports() NOEXCEPT;
+
 
     class Contract
     {
       mutable int _invariantStack;
+      mutable bool _nestedModification;
     public:
-      Contract() : _invariantStack(0) {}
+      Contract() : _invariantStack(0), _nestedModification(false) {}
 
       void pushInvariantOnStack() const NOEXCEPT{
         ++_invariantStack;
       }
 
-        void popInvariantFromStack() const NOEXCEPT{
+      /**
+       * A modifying call that is left within another guarded call is noted,
+       * because the outermost one must then check the complete invariant.
+       */
+      void popInvariantFromStack(bool modifying = false) const NOEXCEPT{
         --_invariantStack;
+        if (modifying && _invariantStack > 0) {
+          _nestedModification = true;
+        }
       }
 
       bool stackEmpty() const NOEXCEPT {
         return _invariantStack == 0;
       }
+
+      /**
+       * Returns and forgets, if a nested guarded call modified the object
+       */
+      bool takeNestedModification() const NOEXCEPT {
+        const auto result = _nestedModification;
+        _nestedModification = false;
+        return result;
+      }
+    };
+
+    /**
+     * Contract that additionally remembers if the object was modified since
+     * its invariant was successfully checked the last time. Every guarded
+     * call through a non const member function counts as modification. A
+     * guarded const member function skips the invariant check, if there was
+     * no modification since. So modifications of mutable members or of
+     * public members from outside are not detected.
+     */
+    class CachedContract : public Contract
+    {
+      mutable std::uint32_t _generation;
+      mutable std::uint32_t _checkedGeneration;
+    public:
+      CachedContract() : _generation(1), _checkedGeneration(0) {}
+
+      void modified() const NOEXCEPT {
+        ++_generation;
+      }
+
+      bool unchanged() const NOEXCEPT {
+        return _generation == _checkedGeneration;
+      }
+
+      void checked() const NOEXCEPT {
+        _checkedGeneration = _generation;
+      }
+    };
+
+    namespace contract_detail
+    {
+      /**
+       * Per thread stack of the objects that are currently inside a contract
+       * guarded member function. Zero initialized, so it needs no constructor.
+       */
+      struct InvariantStack
+      {
+        static const int capacity = 32;
+        const void* objects[capacity];
+        bool nestedModification[capacity];
+        int size;
+        int overflow;
+      };
+
+      inline InvariantStack& invariantStack() NOEXCEPT {
+        static THREAD_LOCAL InvariantStack stack;
+        return stack;
+      }
+    }
+
+    /**
+     * Alternative to Contract that tracks the invariant nesting per thread
+     * instead of per object. So it takes no space within the object and a
+     * const member function never writes to the object. As in Eiffel the
+     * invariant is only checked when the outermost guarded call on an object
+     * is left.
+     */
+    class ThreadLocalContract
+    {
+    public:
+      static void pushInvariantOnStack(const void* object) NOEXCEPT {
+        auto& stack = contract_detail::invariantStack();
+        if (stack.size < contract_detail::InvariantStack::capacity) {
+          stack.objects[stack.size++] = object;
+        }
+        else {
+          ++stack.overflow;
+        }
+      }
+
+      /**
+       * Returns true, if the object is not inside any other guarded call on
+       * this thread. Beyond the capacity of the stack it is not known, so
+       * then false is returned and the invariant is not checked. A modifying
+       * call is passed on to the next outer call on the object, which must
+       * then check the complete invariant. Beyond the capacity it is passed
+       * to all calls on the stack.
+       */
+      static bool popInvariantFromStack(const void* object, bool modifying = false) NOEXCEPT {
+        auto& stack = contract_detail::invariantStack();
+        if (stack.overflow > 0) {
+          --stack.overflow;
+          for (int i = 0; modifying && i < stack.size; ++i) {
+            stack.nestedModification[i] = true;
+          }
+          return false;
+        }
+        --stack.size;
+        for (int i = stack.size; i-- > 0;) {
+          if (stack.objects[i] == object) {
+            if (modifying || stack.nestedModification[stack.size]) {
+              stack.nestedModification[i] = true;
+              stack.nestedModification[stack.size] = false;
+            }
+            return false;
+          }
+        }
+        return true;
+      }
+
+      /**
+       * Returns and forgets, if a nested guarded call modified the object
+       * whose outermost call was just popped
+       */
+      static bool takeNestedModification(const void* object) NOEXCEPT {
+        auto& stack = contract_detail::invariantStack();
+        if (stack.objects[stack.size] != object || !stack.nestedModification[stack.size]) {
+          return false;
+        }
+        stack.nestedModification[stack.size] = false;
+        return true;
+      }
     };
 
     namespace contract_detail 
     {
-      void handleFailedPreCondition(const char* filename, int lineNumber);
+      inline void pushInvariant(const Contract& contract, const void*) NOEXCEPT {
+        contract.pushInvariantOnStack();
+      }
+
+      inline bool popInvariant(const Contract& contract, const void*, bool modifying) NOEXCEPT {
+        contract.popInvariantFromStack(modifying);
+        return contract.stackEmpty();
+      }
+
+      inline bool takeNestedModification(const Contract& contract, const void*) NOEXCEPT {
+        return contract.takeNestedModification();
+      }
+
+      inline void pushInvariant(ThreadLocalContract, const void* object) NOEXCEPT {
+        ThreadLocalContract::pushInvariantOnStack(object);
+      }
+
+      inline bool popInvariant(ThreadLocalContract, const void* object, bool modifying) NOEXCEPT {
+        return ThreadLocalContract::popInvariantFromStack(object, modifying);
+      }
+
+      inline bool takeNestedModification(ThreadLocalContract, const void* object) NOEXCEPT {
+        return ThreadLocalContract::takeNestedModification(object);
+      }
+
+      /**
+       * Only the CachedContract keeps track of modifications. Mutating tells
+       * if the guarded member function is non const.
+       */
+      template <typename Contractor, typename Mutating>
+      void noteEntry(const Contractor&, Mutating) NOEXCEPT {}
 
-      void handleFailedPostCondition(const char* filename, int lineNumber) NOEXCEPT;
+      inline void noteEntry(const CachedContract& contract, std::true_type) NOEXCEPT {
+        contract.modified();
+      }
+
+      template <typename Contractor, typename Mutating>
+      bool invariantUnchanged(const Contractor&, Mutating) NOEXCEPT {
+        return false;
+      }
+
+      inline bool invariantUnchanged(const CachedContract& contract, std::false_type) NOEXCEPT {
+        return contract.unchanged();
+      }
+
+      template <typename Contractor>
+      void noteInvariantChecked(const Contractor&) NOEXCEPT {}
+
+      inline void noteInvariantChecked(const CachedContract& contract) NOEXCEPT {
+        contract.checked();
+      }
 
-      void handleFailedInvariant(const char* filename, int lineNumber) NOEXCEPT;
+      template <typename Context>
+      using is_mutating = std::integral_constant<bool, !std::is_const<typename Context::provider_type>::value>;
+
+      // The handlers may return or throw, so they cannot be declared noreturn
+      CONTRACT_LIGHT_COLD void handleFailedPreCondition(const ContractSite& site, const void* object);
+
+      CONTRACT_LIGHT_COLD void handleFailedPostCondition(const ContractSite& site, const void* object) NOEXCEPT;
+
+      CONTRACT_LIGHT_COLD void handleFailedInvariant(const ContractSite& site, const void* object) NOEXCEPT;
+
+      /**
+       * The number of replaced subscriber snapshots that are not yet freed,
+       * because a failure was reported while they were replaced
+       */
+      std::size_t retiredSubscriberSnapshots();
+
+      template <typename Provider>
+      bool auditDue(const Provider& provider, bool mutating, std::true_type /* has schedule */) NOEXCEPT {
+        return provider.contract_light_audit_schedule().due(mutating);
+      }
+
+      template <typename Provider>
+      bool auditDue(const Provider&, bool, std::false_type) NOEXCEPT {
+        return false;
+      }
+
+      /**
+       * The audit invariant is checked by audit contracts and whenever the
+       * schedule of the class says so
+       */
+      template <typename Context>
+      void checkAuditInvariant(Context&, std::false_type /* has audit invariant */) NOEXCEPT {}
+
+      template <typename Context>
+      void checkAuditInvariant(Context& ctx, std::true_type) NOEXCEPT {
+        using Provider = typename std::remove_const<typename Context::provider_type>::type;
+        const auto& provider = ctx.provider;
+        if (ctx.site.level < CONTRACT_LIGHT_LEVEL_AUDIT &&
+            !auditDue(provider, is_mutating<Context>::value, std::integral_constant<bool, has_audit_schedule<Provider>::value>())) {
+          return;
+        }
+        if (CONTRACT_LIGHT_UNLIKELY(!ctx.checkInvariant([&provider] { return provider.audit_invariant(); }))) {
+          ctx.failed();
+          handleFailedInvariant(ctx.site, &ctx.provider);
+        }
+      }
 
       struct NoInvariantPolicy
       {
@@ -101,20 +462,53 @@ namespace contract_light
         static void checkInvariant(C&) NOEXCEPT{}
       };
 
+      /**
+       * A site that is switched off at runtime skips the invariant nesting
+       * and the check. Only the modification of a CachedContract is still
+       * noted, so that it does not skip a later check.
+       */
       struct InvariantPolicy
       {
         template <typename Context>
         static void pushInvariantOnStack(Context& ctx) NOEXCEPT{
-          ctx.provider.contract_light_contractor().pushInvariantOnStack();
+          noteEntry(ctx.provider.contract_light_contractor(), is_mutating<Context>());
+          if (!switchedOn(static_cast<const typename Context::monitor_type&>(ctx))) {
+            return;
+          }
+          pushInvariant(ctx.provider.contract_light_contractor(), &ctx.provider);
         }
 
         template <typename Context>
         static void checkInvariant(Context& ctx) NOEXCEPT{
-          ctx.provider.contract_light_contractor().popInvariantFromStack();
-          if (ctx.provider.contract_light_contractor().stackEmpty() &&
-            !ctx.provider.invariant()) {
-            handleFailedInvariant(ctx.fileName, ctx.line);
+          if (!switchedOn(static_cast<const typename Context::monitor_type&>(ctx))) {
+            return;
+          }
+          using Provider = typename std::remove_const<typename Context::provider_type>::type;
+          // Only with clauses the modified fields matter. The checks of nested
+          // calls were skipped, so the fields they modified are unknown.
+          const bool clauses = has_invariant_clauses<Provider>::value;
+          const auto& contractor = ctx.provider.contract_light_contractor();
+          if (!popInvariant(contractor, &ctx.provider, clauses && is_mutating<Context>::value)) {
+            return;
+          }
+          const bool nestedModification = clauses && takeNestedModification(contractor, &ctx.provider);
+          if (invariantUnchanged(contractor, is_mutating<Context>())) {
+            return;
+          }
+          const auto& provider = ctx.provider;
+          if (CONTRACT_LIGHT_UNLIKELY(!ctx.checkInvariant([&provider, nestedModification] {
+                return nestedModification ? checkInvariantOf(provider, AllFields())
+                                          : checkInvariantOf(provider, typename Context::modified_type()); }))) {
+            ctx.failed();
+            handleFailedInvariant(ctx.site, &ctx.provider);
+            return;
           }
+          // A call that is not sampled did not evaluate the invariant
+          if (!ctx.sampled()) {
+            return;
+          }
+          noteInvariantChecked(contractor);
+          checkAuditInvariant(ctx, std::integral_constant<bool, has_audit_invariant<Provider>::value>());
         }
       };
 
@@ -123,8 +517,9 @@ namespace contract_light
       class PreCondition
       {
         using Provider = typename Context::provider_type;
+        using Monitor = typename Context::monitor_type;
 
-        using InvariantPolicy = IF_t<has_invariant<Provider>::value, 
+        using Policy = IF_t<has_invariant<Provider>::value, 
                                      InvariantPolicy, 
                                      NoInvariantPolicy>;
 
@@ -132,24 +527,25 @@ namespace contract_light
           (has_invariant<Provider>::value && has_contractor<Provider>::value),
           "A class that uses invariants must use CONTRACTOR!");
 
-        const Context _context;
+        const GuardState<Provider, Monitor, typename Context::modified_type> _context;
 
       public:
-        PreCondition(Context&& ctx, Op&& op) : _context(std::forward<Context>(ctx)) {
+        PreCondition(Context&& ctx, Op&& op) : _context(ctx) {
           
           static_assert(std::is_same<bool, decltype(op())>::value,
             "Pre-Condition must be a callable object returning a boolean");
 
-          if (!op()) {
-            handleFailedPreCondition(_context.fileName, _context.line);
+          if (CONTRACT_LIGHT_UNLIKELY(!_context.evaluate(op))) {
+            _context.failed();
+            handleFailedPreCondition(_context.site, &ctx.provider);
           }
 
-          InvariantPolicy::pushInvariantOnStack(_context);
+          Policy::pushInvariantOnStack(_context);
         }
 
         ~PreCondition()
         {
-          InvariantPolicy::checkInvariant(_context);
+          Policy::checkInvariant(_context);
         }
       };
 
@@ -157,8 +553,9 @@ namespace contract_light
       class PostCondition
       {
         using Provider = typename Context::provider_type;
+        using Monitor = typename Context::monitor_type;
 
-        using InvariantPolicy = IF_t<has_invariant<Provider>::value,
+        using Policy = IF_t<has_invariant<Provider>::value,
                                       InvariantPolicy,
                                       NoInvariantPolicy>;
 
@@ -166,26 +563,95 @@ namespace contract_light
           (has_invariant<Provider>::value && has_contractor<Provider>::value),
           "A class that uses invariants must use CONTRACTOR!");
 
-        const Context _context;
+        const GuardState<Provider, Monitor, typename Context::modified_type> _context;
+        // The predicate is a temporary of the makro expression, so it must be
+        // kept by value. Capturing by reference keeps it at pointer size.
         Op _op;
 
       public:
         PostCondition(Context&& ctx, Op&& op)
-          : _context(std::forward<Context>(ctx))
+          : _context(ctx)
           , _op(std::forward<Op>(op)) {
           
           static_assert(std::is_same<bool, decltype(op())>::value,
             "Post-Condition must be a callable object returning a boolean");
 
-          InvariantPolicy::pushInvariantOnStack(_context);
+          Policy::pushInvariantOnStack(_context);
         }
 
         ~PostCondition() {
-          if (!_op()) {
-            handleFailedPostCondition(_context.fileName, _context.line);
+          if (CONTRACT_LIGHT_UNLIKELY(!_context.evaluate(_op))) {
+            _context.failed();
+            handleFailedPostCondition(_context.site, _context.object());
           }
 
-          InvariantPolicy::checkInvariant(_context);
+          Policy::checkInvariant(_context);
+        }
+      };
+
+
+      /**
+       * A postcondition on the returned object. The predicate gets the result
+       * as its argument when it is returned through RETURN_CHECKED or
+       * RETURN_CHECKED_LOCAL. The result is only referenced by the check. The
+       * invariant is checked when the scope is left, as with any other
+       * postcondition.
+       */
+      template <typename Context, typename Op>
+      class ResultCondition
+      {
+        using Provider = typename Context::provider_type;
+        using Monitor = typename Context::monitor_type;
+
+        using Policy = IF_t<has_invariant<Provider>::value,
+                                      InvariantPolicy,
+                                      NoInvariantPolicy>;
+
+        static_assert(!has_invariant<Provider>::value ||
+          (has_invariant<Provider>::value && has_contractor<Provider>::value),
+          "A class that uses invariants must use CONTRACTOR!");
+
+        const GuardState<Provider, Monitor, typename Context::modified_type> _context;
+        Op _op;
+
+      public:
+        ResultCondition(Context&& ctx, Op&& op)
+          : _context(ctx)
+          , _op(std::forward<Op>(op)) {
+
+          Policy::pushInvariantOnStack(_context);
+        }
+
+        ~ResultCondition() {
+          Policy::checkInvariant(_context);
+        }
+
+        template <typename Expression>
+        auto checkResult(const Expression& expression) const -> decltype(expression()) {
+          using Result = decltype(expression());
+          static_assert(std::is_move_constructible<Result>::value,
+            "The result of RETURN_CHECKED must be move constructible");
+
+          // Single named return value, so the compiler may construct it in
+          // the return slot (NRVO). C++11 does not guarantee that, otherwise
+          // it is moved.
+          Result result(expression());
+          checkLocal(result);
+          return result;
+        }
+
+        /**
+         * Checks a named local of the function in place. The function returns
+         * it itself, so that it is treated like by a plain return.
+         */
+        template <typename Result>
+        void checkLocal(const Result& result) const {
+          static_assert(std::is_same<bool, decltype(_op(result))>::value,
+            "Result-Condition must be a callable object taking the result and returning a boolean");
+          if (CONTRACT_LIGHT_UNLIKELY(!_context.evaluate([this, &result] { return _op(result); }))) {
+            _context.failed();
+            handleFailedPostCondition(_context.site, _context.object());
+          }
         }
       };
 
@@ -196,10 +662,10 @@ namespace contract_light
         static_assert(has_invariant<typename Context::provider_type>::value,
           "An Invariant can only be used if the Provider class has a bool invariant() const method");
 
-        const Context _context;
+        const GuardState<typename Context::provider_type, typename Context::monitor_type, typename Context::modified_type, true> _context;
       public:
         Invariant(Context&& ctx)
-          : _context(std::forward<Context>(ctx)) {
+          : _context(ctx) {
 
           InvariantPolicy::pushInvariantOnStack(_context);
         }
@@ -210,23 +676,116 @@ namespace contract_light
       };
 
 
-      template <typename T, typename Op>
-      PreCondition<PreConditionContext<T>, Op> operator+(PreConditionContext<T>&& ctx, Op&& op) {
-        using Context = PreConditionContext < T > ;
+      /**
+       * Keeps the invariant nesting of an object raised for its lifetime, so
+       * that the guarded calls within only check the invariant once at the
+       * end. With CheckOnEntry the invariant is checked at the beginning as
+       * well, if the object is not already inside a guarded call.
+       */
+      template <typename Context, bool CheckOnEntry>
+      class Transaction
+      {
+        using Provider = typename Context::provider_type;
+
+        static_assert(has_invariant<Provider>::value,
+          "A transaction can only be used if the Provider class has a bool invariant() const method");
+        static_assert(has_contractor<Provider>::value,
+          "A class that uses invariants must use CONTRACTOR!");
+
+        const GuardState<Provider, typename Context::monitor_type, AllFields, true> _context;
+      public:
+        explicit Transaction(Context&& ctx)
+          : _context(ctx) {
+
+          if (CheckOnEntry) {
+            InvariantPolicy::pushInvariantOnStack(_context);
+            InvariantPolicy::checkInvariant(_context);
+          }
+          InvariantPolicy::pushInvariantOnStack(_context);
+        }
+
+        ~Transaction() {
+          InvariantPolicy::checkInvariant(_context);
+        }
+      };
+
+
+      template <typename T, typename Monitor, typename Modified, typename Op>
+      PreCondition<PreConditionContext<T, Monitor, Modified>, Op> operator+(PreConditionContext<T, Monitor, Modified>&& ctx, Op&& op) {
+        using Context = PreConditionContext < T, Monitor, Modified > ;
         return PreCondition<Context, Op>(std::forward<Context>(ctx), std::forward<Op>(op));
       }
 
 
-      template <typename T, typename Op>
-      PostCondition<PostConditionContext<T>, Op> operator+(PostConditionContext<T>&& ctx, Op&& op) {
-        using Context = PostConditionContext < T > ;
+      template <typename T, typename Monitor, typename Modified, typename Op>
+      PostCondition<PostConditionContext<T, Monitor, Modified>, Op> operator+(PostConditionContext<T, Monitor, Modified>&& ctx, Op&& op) {
+        using Context = PostConditionContext < T, Monitor, Modified > ;
         return PostCondition<Context, Op>(std::forward<Context>(ctx), std::forward<Op>(op));
       }
 
-      template <typename T>
-      Invariant<ContractContext<T>> makeInvariant(ContractContext<T>&& ctx) {
-        return Invariant<ContractContext<T>>(std::forward<ContractContext<T>>(ctx));
+      template <typename T, typename Monitor, typename Modified, typename Op>
+      ResultCondition<ResultConditionContext<T, Monitor, Modified>, Op> operator+(ResultConditionContext<T, Monitor, Modified>&& ctx, Op&& op) {
+        using Context = ResultConditionContext < T, Monitor, Modified > ;
+        return ResultCondition<Context, Op>(std::forward<Context>(ctx), std::forward<Op>(op));
       }
+
+      template <typename T, typename Monitor, typename Modified>
+      Invariant<ContractContext<T, Monitor, Modified>> makeInvariant(T& provider, const ContractSite& site, const Monitor& monitor, Modified) {
+        return Invariant<ContractContext<T, Monitor, Modified>>(ContractContext<T, Monitor, Modified>(provider, site, monitor));
+      }
+
+      template <bool CheckOnEntry, typename T, typename Monitor>
+      Transaction<ContractContext<T, Monitor>, CheckOnEntry> makeTransaction(T& provider, const ContractSite& site, const Monitor& monitor) {
+        return Transaction<ContractContext<T, Monitor>, CheckOnEntry>(ContractContext<T, Monitor>(provider, site, monitor));
+      }
+
+      template <typename T, typename Monitor, typename Modified>
+      PreConditionContext<T, Monitor, Modified> makePreConditionContext(T& provider, const ContractSite& site, const Monitor& monitor, Modified) {
+        return PreConditionContext<T, Monitor, Modified>(provider, site, monitor);
+      }
+
+      template <typename T, typename Monitor, typename Modified>
+      PostConditionContext<T, Monitor, Modified> makePostConditionContext(T& provider, const ContractSite& site, const Monitor& monitor, Modified) {
+        return PostConditionContext<T, Monitor, Modified>(provider, site, monitor);
+      }
+
+      template <typename T, typename Monitor, typename Modified>
+      ResultConditionContext<T, Monitor, Modified> makeResultConditionContext(T& provider, const ContractSite& site, const Monitor& monitor, Modified) {
+        return ResultConditionContext<T, Monitor, Modified>(provider, site, monitor);
+      }
+
+      /**
+       * Placeholder for a condition that is disabled by the contract level.
+       * It is only used in a branch that is never taken, so neither the
+       * callable object is evaluated nor any guard is created. It just keeps
+       * the type checks of the enabled version.
+       */
+      struct DisabledCondition
+      {
+        template <typename Op>
+        void operator+(Op&& op) const NOEXCEPT {
+          static_assert(std::is_same<bool, decltype(op())>::value,
+            "Condition must be a callable object returning a boolean");
+        }
+      };
+
+      /**
+       * Placeholder for a disabled result condition. RETURN_CHECKED and
+       * RETURN_CHECKED_LOCAL just return the result.
+       */
+      struct DisabledResultCondition
+      {
+        template <typename Op>
+        void operator+(Op&&) const NOEXCEPT {}
+
+        template <typename Expression>
+        auto checkResult(const Expression& expression) const -> decltype(expression()) {
+          return expression();
+        }
+
+        template <typename Result>
+        void checkLocal(const Result&) const NOEXCEPT {}
+      };
     }
   }
 #ifndef HAS_INLINE_NAMESPACE
@@ -238,35 +797,274 @@ namespace contract_light
  * This makro must be set inside the member definition area of a class that has
  * an invariant. It creates a member and it's accessor that is used by the 
  * pre-and post-condtions and invariants.
+ * If CONTRACT_LIGHT_THREAD_LOCAL_CONTRACTOR is defined, it is the same as 
+ * CONTRACTOR_THREAD_LOCAL. As it changes the layout of the classes, it must be
+ * defined identically in all translation units.
  */
-#define CONTRACTOR                                                            \
+#define CONTRACTOR_PER_OBJECT                                                 \
 public:                                                                       \
   ::contract_light::v_100::Contract& contract_light_contractor() const { return _contract_light_contractor; } \
 private:                                                                      \
   mutable ::contract_light::v_100::Contract _contract_light_contractor;
 
+/**
+ * Same as CONTRACTOR, but the invariant nesting is tracked per thread, so it
+ * adds no member to the class.
+ */
+#define CONTRACTOR_THREAD_LOCAL                                               \
+public:                                                                       \
+  static ::contract_light::v_100::ThreadLocalContract contract_light_contractor() { \
+    return ::contract_light::v_100::ThreadLocalContract();                    \
+  }                                                                           \
+private:
+
+/**
+ * Same as CONTRACTOR, but the object additionally remembers if it was
+ * modified since the last successful invariant check. Guarded const member
+ * functions skip the invariant check if not. Only for classes whose
+ * invariant does not depend on mutable members and that are only modified
+ * through guarded member functions.
+ */
+#define CONTRACTOR_CACHED                                                     \
+public:                                                                       \
+  ::contract_light::v_100::CachedContract& contract_light_contractor() const { return _contract_light_contractor; } \
+private:                                                                      \
+  mutable ::contract_light::v_100::CachedContract _contract_light_contractor;
+
+#ifdef CONTRACT_LIGHT_THREAD_LOCAL_CONTRACTOR
+#define CONTRACTOR CONTRACTOR_THREAD_LOCAL
+#else
+#define CONTRACTOR CONTRACTOR_PER_OBJECT
+#endif
+
+#define CONTRACT_LIGHT_PRECONDITION_ENABLED(level) CONTRACT_LIGHT_PRECONDITION_IMPL(level, CONTRACT_LIGHT_SITE_TAG(_PRE, level))
+#define CONTRACT_LIGHT_PRECONDITION_IMPL(level, id)                           \
+      CONTRACT_LIGHT_SITE(CONCATENATE(CONTRACT_SITE, id),                     \
+        ::contract_light::ContractKind::PreCondition, level, nullptr);        \
+      CONTRACT_LIGHT_SITE_MONITOR(CONCATENATE(CONTRACT_MONITOR, id), CONCATENATE(CONTRACT_SITE, id), *this); \
+      auto CONCATENATE(CONTRACT_STATE, id) =                                  \
+      ::contract_light::contract_detail::makePreConditionContext(*this, CONCATENATE(CONTRACT_SITE, id), CONCATENATE(CONTRACT_MONITOR, id), contract_light_modified_fields()) + 
+
+#define CONTRACT_LIGHT_POSTCONDITION_ENABLED(level) CONTRACT_LIGHT_POSTCONDITION_IMPL(level, CONTRACT_LIGHT_SITE_TAG(_POST, level))
+#define CONTRACT_LIGHT_POSTCONDITION_IMPL(level, id)                          \
+      CONTRACT_LIGHT_SITE(CONCATENATE(CONTRACT_SITE, id),                     \
+        ::contract_light::ContractKind::PostCondition, level, nullptr);       \
+      CONTRACT_LIGHT_SITE_MONITOR(CONCATENATE(CONTRACT_MONITOR, id), CONCATENATE(CONTRACT_SITE, id), *this); \
+      ::contract_light::contract_detail::captureOlds(contract_light_olds_in_scope(), CONCATENATE(CONTRACT_MONITOR, id)); \
+      auto CONCATENATE(CONTRACT_STATE, id) =                                  \
+      ::contract_light::contract_detail::makePostConditionContext(*this, CONCATENATE(CONTRACT_SITE, id), CONCATENATE(CONTRACT_MONITOR, id), contract_light_modified_fields()) + 
+
+#define CONTRACT_LIGHT_RESULT_CONDITION_ENABLED(level) CONTRACT_LIGHT_RESULT_CONDITION_IMPL(level, CONTRACT_LIGHT_SITE_TAG(_RESULT, level))
+#define CONTRACT_LIGHT_RESULT_CONDITION_IMPL(level, id)                       \
+      CONTRACT_LIGHT_SITE(CONCATENATE(CONTRACT_SITE, id),                     \
+        ::contract_light::ContractKind::PostCondition, level, nullptr);       \
+      CONTRACT_LIGHT_SITE_MONITOR(CONCATENATE(CONTRACT_MONITOR, id), CONCATENATE(CONTRACT_SITE, id), *this); \
+      ::contract_light::contract_detail::captureOlds(contract_light_olds_in_scope(), CONCATENATE(CONTRACT_MONITOR, id)); \
+      auto contract_light_result =                                            \
+      ::contract_light::contract_detail::makeResultConditionContext(*this, CONCATENATE(CONTRACT_SITE, id), CONCATENATE(CONTRACT_MONITOR, id), contract_light_modified_fields()) + 
+
+#define CONTRACT_LIGHT_DEFERRED_ENABLED(level) CONTRACT_LIGHT_DEFERRED_IMPL(level, CONTRACT_LIGHT_SITE_TAG(_DEFERRED, level))
+#define CONTRACT_LIGHT_DEFERRED_IMPL(level, id)                               \
+      CONTRACT_LIGHT_SITE(CONCATENATE(CONTRACT_SITE, id),                     \
+        ::contract_light::ContractKind::Deferred, level, nullptr);            \
+      CONTRACT_LIGHT_SWITCH_MONITOR(CONCATENATE(CONTRACT_SWITCH, id), CONCATENATE(CONTRACT_SITE, id), \
+        static_cast<const char*>(nullptr)); \
+      CONTRACT_LIGHT_SAMPLING_MONITOR(CONCATENATE(CONTRACT_SAMPLING, id), CONCATENATE(CONTRACT_SITE, id)); \
+      ::contract_light::contract_detail::makeDeferredContext(CONCATENATE(CONTRACT_SITE, id), \
+        ::contract_light::contract_detail::combineMonitors(CONCATENATE(CONTRACT_SWITCH, id), CONCATENATE(CONTRACT_SAMPLING, id))) + 
+
+#define CONTRACT_LIGHT_INVARIANT_ENABLED(level) CONTRACT_LIGHT_INVARIANT_IMPL(level, CONTRACT_LIGHT_SITE_TAG(_INVARIANT, level))
+#define CONTRACT_LIGHT_INVARIANT_IMPL(level, id)                              \
+      CONTRACT_LIGHT_SITE(CONCATENATE(CONTRACT_SITE, id),                     \
+        ::contract_light::ContractKind::Invariant, level, "invariant()");     \
+      CONTRACT_LIGHT_SITE_MONITOR(CONCATENATE(CONTRACT_MONITOR, id), CONCATENATE(CONTRACT_SITE, id), *this); \
+      auto CONCATENATE(CONTRACT_STATE, id) =                                  \
+      ::contract_light::contract_detail::makeInvariant(*this, CONCATENATE(CONTRACT_SITE, id), CONCATENATE(CONTRACT_MONITOR, id), contract_light_modified_fields());
+
+#define CONTRACT_LIGHT_TRANSACTION_ENABLED(obj, checkOnEntry) CONTRACT_LIGHT_TRANSACTION_IMPL(obj, checkOnEntry, CONTRACT_LIGHT_SITE_TAG(_TRANSACTION, CONTRACT_LIGHT_LEVEL_DEFAULT))
+#define CONTRACT_LIGHT_TRANSACTION_IMPL(obj, checkOnEntry, id)                \
+      CONTRACT_LIGHT_SITE(CONCATENATE(CONTRACT_SITE, id),                     \
+        ::contract_light::ContractKind::Invariant, CONTRACT_LIGHT_LEVEL_DEFAULT, "invariant()"); \
+      CONTRACT_LIGHT_SITE_MONITOR(CONCATENATE(CONTRACT_MONITOR, id), CONCATENATE(CONTRACT_SITE, id), obj); \
+      auto CONCATENATE(CONTRACT_STATE, id) =                                  \
+      ::contract_light::contract_detail::makeTransaction<checkOnEntry>(obj, CONCATENATE(CONTRACT_SITE, id), CONCATENATE(CONTRACT_MONITOR, id))
+
+#define CONTRACT_LIGHT_TRANSACTION_DISABLED(obj)                              \
+      static_assert(::contract_light::contract_detail::has_invariant<std::remove_reference<decltype(obj)>::type>::value, \
+        "A transaction can only be used if the Provider class has a bool invariant() const method")
+
+/**
+ * A disabled condition swallows the following callable object in a never 
+ * taken branch. So no code is generated, but the callable is still compiled.
+ */
+#define CONTRACT_LIGHT_CONDITION_DISABLED                                     \
+      if (true) {} else ::contract_light::contract_detail::DisabledCondition() + 
+
+#define CONTRACT_LIGHT_RESULT_CONDITION_DISABLED                              \
+      const ::contract_light::contract_detail::DisabledResultCondition contract_light_result = {}; \
+      if (true) {} else contract_light_result + 
+
+#define CONTRACT_LIGHT_INVARIANT_DISABLED                                     \
+      static_assert(::contract_light::contract_detail::has_invariant<std::remove_reference<decltype(*this)>::type>::value, \
+        "An Invariant can only be used if the Provider class has a bool invariant() const method");
+
 /**
  * Defines a precondtion. Must be followed by a callable object.
  * Several ones can be defined within a single function
  * the current scope is left. As well the invariant is checked whenever one is defined.
  * E.g. PRECONDITION [this]{ return myMember_ > 42;};
+ * PRECONDITION_AUDIT is only compiled in with CONTRACT_LIGHT_LEVEL_AUDIT.
   */
-#define PRECONDITION auto ANONYMOUS_VARIABLE(CONTRACT_STATE) =                \
-      ::contract_light::contract_detail::PreConditionContext<std::remove_reference<decltype(*this)>::type>(*this, __FILE__, __LINE__) + 
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_DEFAULT
+#define PRECONDITION CONTRACT_LIGHT_PRECONDITION_ENABLED(CONTRACT_LIGHT_LEVEL_DEFAULT)
+#else
+#define PRECONDITION CONTRACT_LIGHT_CONDITION_DISABLED
+#endif
+
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_AUDIT
+#define PRECONDITION_AUDIT CONTRACT_LIGHT_PRECONDITION_ENABLED(CONTRACT_LIGHT_LEVEL_AUDIT)
+#else
+#define PRECONDITION_AUDIT CONTRACT_LIGHT_CONDITION_DISABLED
+#endif
 
 /**
  * Defines a postcondtion. Must be followed by a callable object.
  * Several ones can be defined within a single function. The check is executed whenever
  * the current scope is left. As well the invariant is checked whenever one is defined.
  * E.g. POSTCONDITION [this]{ return result > 42;};
+ * POSTCONDITION_AUDIT is only compiled in with CONTRACT_LIGHT_LEVEL_AUDIT.
   */
-#define POSTCONDITION auto ANONYMOUS_VARIABLE(CONTRACT_STATE) =               \
-      ::contract_light::contract_detail::PostConditionContext<std::remove_reference<decltype(*this)>::type>(*this, __FILE__, __LINE__) + 
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_DEFAULT
+#define POSTCONDITION CONTRACT_LIGHT_POSTCONDITION_ENABLED(CONTRACT_LIGHT_LEVEL_DEFAULT)
+#else
+#define POSTCONDITION CONTRACT_LIGHT_CONDITION_DISABLED
+#endif
+
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_AUDIT
+#define POSTCONDITION_AUDIT CONTRACT_LIGHT_POSTCONDITION_ENABLED(CONTRACT_LIGHT_LEVEL_AUDIT)
+#else
+#define POSTCONDITION_AUDIT CONTRACT_LIGHT_CONDITION_DISABLED
+#endif
+
+/**
+ * Defines a postcondition on the returned object. Must be followed by a
+ * callable object that takes the result by const reference. The result is
+ * checked by returning it with RETURN_CHECKED(expr), so no named local is
+ * needed. A temporary, e.g. RETURN_CHECKED(Matrix(n, n)), is never copied,
+ * but it must be move constructible: it is built in a single named local
+ * that is returned, so it is only moved if the compiler does not apply the
+ * named return value optimization (GCC and Clang apply it even without
+ * optimization, MSVC debug builds do not). An lvalue, e.g. a member, is
+ * copied, as by a plain return. A named local of the function is returned
+ * with RETURN_CHECKED_LOCAL(name) instead. It is checked in place and
+ * returned by a plain return statement, so it is copied or moved exactly
+ * as without the check, and a move only local works as well. Returns
+ * without RETURN_CHECKED or RETURN_CHECKED_LOCAL are not checked. Only one
+ * is allowed per function.
+ * E.g. POSTCONDITION_RESULT [&](const Matrix& m){ return m.rows() == n;}; ... RETURN_CHECKED(Matrix(n, n));
+ * POSTCONDITION_RESULT_AUDIT is only compiled in with CONTRACT_LIGHT_LEVEL_AUDIT.
+ */
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_DEFAULT
+#define POSTCONDITION_RESULT CONTRACT_LIGHT_RESULT_CONDITION_ENABLED(CONTRACT_LIGHT_LEVEL_DEFAULT)
+#else
+#define POSTCONDITION_RESULT CONTRACT_LIGHT_RESULT_CONDITION_DISABLED
+#endif
+
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_AUDIT
+#define POSTCONDITION_RESULT_AUDIT CONTRACT_LIGHT_RESULT_CONDITION_ENABLED(CONTRACT_LIGHT_LEVEL_AUDIT)
+#else
+#define POSTCONDITION_RESULT_AUDIT CONTRACT_LIGHT_RESULT_CONDITION_DISABLED
+#endif
+
+#define RETURN_CHECKED(expr) return contract_light_result.checkResult([&] { return expr; })
+#define RETURN_CHECKED_LOCAL(name)                                            \
+  do { contract_light_result.checkLocal(name); return name; } while (false)
+
+/**
+ * Defines a transaction on the object until the current scope is left. All
+ * guarded calls on the object within skip their invariant checks, instead it
+ * is checked once when the scope is left. That makes a batch of calls, e.g.
+ * a bulk load, cheap. With CONTRACT_LIGHT_LEVEL_AUDIT the invariant is
+ * checked at the beginning of the transaction as well.
+ * E.g. CONTRACT_TRANSACTION(container); for (auto& v : values) container.insert(v);
+ */
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_AUDIT
+#define CONTRACT_TRANSACTION(obj) CONTRACT_LIGHT_TRANSACTION_ENABLED(obj, true)
+#elif CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_DEFAULT
+#define CONTRACT_TRANSACTION(obj) CONTRACT_LIGHT_TRANSACTION_ENABLED(obj, false)
+#else
+#define CONTRACT_TRANSACTION(obj) CONTRACT_LIGHT_TRANSACTION_DISABLED(obj)
+#endif
+
+/**
+ * Declares the fields, as tag types, that the current member function
+ * modifies. The invariant checks of the following contracts then only
+ * evaluate the clauses of CONTRACT_INVARIANT_CLAUSES that depend on these
+ * fields. The selection is done at compile time. If a modifying guarded
+ * call on the same object was nested in the function, its skipped check is
+ * made up by checking all clauses.
+ * E.g. MODIFIES(Width); PRECONDITION[&]{ return newWidth > 0; };
+ */
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_DEFAULT
+#define MODIFIES(...) CONTRACT_LIGHT_MODIFIES_ENABLED(__VA_ARGS__)
+#else
+#define MODIFIES(...) static_assert(true, "")
+#endif
+
+/**
+ * Defines a copy of the value of an expression at the entry of a function,
+ * that can be accessed by the following postcondition with *name or name->.
+ * It must be defined directly before its postcondition, because it is
+ * evaluated by the next postcondition of the scope, and only if this one
+ * is checked.
+ * E.g. OLD(oldSize, _values.size()); POSTCONDITION [&]{ return _values.size() == *oldSize + 1;};
+ * OLD_AUDIT belongs to a POSTCONDITION_AUDIT and is only compiled in with
+ * CONTRACT_LIGHT_LEVEL_AUDIT.
+ */
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_DEFAULT
+#define OLD(name, expr) CONTRACT_LIGHT_OLD_ENABLED(name, expr)
+#else
+#define OLD(name, expr) CONTRACT_LIGHT_OLD_DISABLED(name, expr)
+#endif
+
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_AUDIT
+#define OLD_AUDIT(name, expr) CONTRACT_LIGHT_OLD_ENABLED(name, expr)
+#else
+#define OLD_AUDIT(name, expr) CONTRACT_LIGHT_OLD_DISABLED(name, expr)
+#endif
+
+/**
+ * Defines an audit check that is evaluated later by the deferred checker
+ * thread, see startDeferredChecker(). Must be followed by a callable object
+ * that captures everything it needs by value or as shared immutable
+ * snapshot, because the function may have returned when it is evaluated.
+ * The calling thread only moves it into a lock-free queue; if the queue is
+ * full, the check is dropped and counted. A check that throws is reported
+ * as failed.
+ * E.g. DEFERRED_AUDIT [=]{ return std::is_sorted(snapshot->begin(), snapshot->end()); };
+ * It is compiled in with CONTRACT_LIGHT_LEVEL_AUDIT, or with
+ * CONTRACT_LIGHT_DEFERRED_AUDIT also on the default level.
+ */
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_AUDIT || \
+    (CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_DEFAULT && defined(CONTRACT_LIGHT_DEFERRED_AUDIT))
+#define DEFERRED_AUDIT CONTRACT_LIGHT_DEFERRED_ENABLED(CONTRACT_LIGHT_LEVEL_AUDIT)
+#else
+#define DEFERRED_AUDIT CONTRACT_LIGHT_CONDITION_DISABLED
+#endif
 
 /**
  * Defines that the invariant shall be called whenever the current scope is left
  * E.g. INVARIANT;
+ * INVARIANT_AUDIT is only compiled in with CONTRACT_LIGHT_LEVEL_AUDIT.
   */
-#define INVARIANT auto ANONYMOUS_VARIABLE(CONTRACT_STATE) =                   \
-      ::contract_light::contract_detail::makeInvariant(::contract_light::contract_detail::ContractContext<std::remove_reference<decltype(*this)>::type>(*this, __FILE__, __LINE__));
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_DEFAULT
+#define INVARIANT CONTRACT_LIGHT_INVARIANT_ENABLED(CONTRACT_LIGHT_LEVEL_DEFAULT)
+#else
+#define INVARIANT CONTRACT_LIGHT_INVARIANT_DISABLED
+#endif
 
+#if CONTRACT_LIGHT_LEVEL >= CONTRACT_LIGHT_LEVEL_AUDIT
+#define INVARIANT_AUDIT CONTRACT_LIGHT_INVARIANT_ENABLED(CONTRACT_LIGHT_LEVEL_AUDIT)
+#else
+#define INVARIANT_AUDIT CONTRACT_LIGHT_INVARIANT_DISABLED
+#endif
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    /**
+     * Schedule that checks the audit invariant of an object on every n-th
+     * invariant check after a guarded non const member function
+     */
+    template <std::uint32_t N>
+    class AuditEveryNthMutation
+    {
+      static_assert(N > 0, "The audit invariant must be checked at least on every mutation");
+      mutable std::uint32_t _mutations;
+    public:
+      AuditEveryNthMutation() : _mutations(0) {}
+
+      bool due(bool mutating) const NOEXCEPT {
+        if (!mutating || ++_mutations < N) {
+          return false;
+        }
+        _mutations = 0;
+        return true;
+      }
+    };
+
+    /**
+     * Schedule that checks the audit invariant of an object at most once per
+     * interval, on the first invariant check after the interval elapsed
+     */
+    template <std::uint32_t Milliseconds>
+    class AuditEveryInterval
+    {
+      mutable std::chrono::steady_clock::time_point _next;
+    public:
+      AuditEveryInterval() : _next() {}
+
+      bool due(bool) const NOEXCEPT {
+        const auto now = std::chrono::steady_clock::now();
+        if (now < _next) {
+          return false;
+        }
+        _next = now + std::chrono::milliseconds(Milliseconds);
+        return true;
+      }
+    };
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
+
+/**
+ * Declares the schedule of the audit_invariant() of a class, e.g.
+ * CONTRACT_AUDIT_SCHEDULE(contract_light::AuditEveryNthMutation<100>).
+ * It must be set inside the member definition area of the class and keeps
+ * the state of the schedule per object. Independent of it the audit
+ * invariant is checked by all audit contracts, that are only compiled in
+ * with CONTRACT_LIGHT_LEVEL_AUDIT.
+ */
+#define CONTRACT_AUDIT_SCHEDULE(...)                                          \
+public:                                                                       \
+  const __VA_ARGS__& contract_light_audit_schedule() const { return _contract_light_audit_schedule; } \
+private:                                                                      \
+  __VA_ARGS__ _contract_light_audit_schedule;
@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+
+#include <type_traits>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    /**
+     * The fields that the current member function modifies, each named by an
+     * arbitrary tag type
+     */
+    template <typename... Tags>
+    struct Fields {};
+
+    /**
+     * A member function may modify any field, so the complete invariant is
+     * checked
+     */
+    struct AllFields {};
+
+    /**
+     * A single clause of the invariant, a bool Check() const member function,
+     * and the tags of the fields it depends on
+     */
+    template <typename Method, Method Check, typename... DependsOn>
+    struct Clause {};
+
+    /**
+     * All clauses of the invariant of a class
+     */
+    template <typename... Clause>
+    struct InvariantClauses {};
+
+    namespace contract_detail
+    {
+      template <typename Tag, typename... Tags>
+      struct contains_tag : std::false_type {};
+
+      template <typename Tag, typename First, typename... Rest>
+      struct contains_tag<Tag, First, Rest...>
+        : std::integral_constant<bool, std::is_same<Tag, First>::value || contains_tag<Tag, Rest...>::value> {};
+
+      /**
+       * True, if one of the modified fields is one the clause depends on
+       */
+      template <typename Modified, typename... DependsOn>
+      struct depends_on_any : std::false_type {};
+
+      template <typename First, typename... Rest, typename... DependsOn>
+      struct depends_on_any<Fields<First, Rest...>, DependsOn...>
+        : std::integral_constant<bool, contains_tag<First, DependsOn...>::value ||
+                                       depends_on_any<Fields<Rest...>, DependsOn...>::value> {};
+
+      template <typename... DependsOn>
+      struct depends_on_any<AllFields, DependsOn...> : std::true_type {};
+
+      template <typename T, typename Modified>
+      bool checkClauses(const T&, Modified, InvariantClauses<>) {
+        return true;
+      }
+
+      template <typename T, typename Modified, typename Method, Method Check, typename... DependsOn, typename... Rest>
+      bool checkClauses(const T& provider, Modified modified, InvariantClauses<Clause<Method, Check, DependsOn...>, Rest...>) {
+        // The condition is a compile time constant, so unaffected clauses vanish
+        if (depends_on_any<Modified, DependsOn...>::value && !(provider.*Check)()) {
+          return false;
+        }
+        return checkClauses(provider, modified, InvariantClauses<Rest...>());
+      }
+
+      /**
+       * Traits checks if the given type declares its invariant clauses
+       */
+      template <typename T>
+      class has_invariant_clauses
+      {
+        template<typename U>
+        static std::true_type try_type(typename U::contract_light_invariant_clauses*);
+
+        template<typename U>
+        static std::false_type try_type(...);
+
+        using result_type = decltype(try_type<T>(nullptr));
+      public:
+        static const bool value = result_type::value;
+      };
+
+      template <typename T>
+      bool checkInvariantOf(const T& provider, AllFields) {
+        return provider.invariant();
+      }
+
+      template <typename T, typename... Tags>
+      bool checkInvariantOf(const T& provider, Fields<Tags...>, std::false_type /* has clauses */) {
+        return provider.invariant();
+      }
+
+      template <typename T, typename... Tags>
+      bool checkInvariantOf(const T& provider, Fields<Tags...> modified, std::true_type) {
+        return checkClauses(provider, modified, typename T::contract_light_invariant_clauses());
+      }
+
+      template <typename T, typename... Tags>
+      bool checkInvariantOf(const T& provider, Fields<Tags...> modified) {
+        return checkInvariantOf(provider, modified, std::integral_constant<bool, has_invariant_clauses<T>::value>());
+      }
+    }
+
+    /**
+     * Checks all clauses of the invariant, e.g. as implementation of invariant()
+     */
+    template <typename T>
+    bool checkInvariantClauses(const T& provider) {
+      return contract_detail::checkClauses(provider, AllFields(), typename T::contract_light_invariant_clauses());
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
+
+/**
+ * Outside of a member function with MODIFIES, all fields may be modified
+ */
+typedef ::contract_light::AllFields contract_light_modified_fields;
+
+/**
+ * Declares the clauses of the invariant of a class, each made with
+ * CONTRACT_CLAUSE. It must be set inside the member definition area of the
+ * class after the clause member functions.
+ */
+#define CONTRACT_INVARIANT_CLAUSES(...)                                       \
+public:                                                                       \
+  typedef ::contract_light::InvariantClauses<__VA_ARGS__> contract_light_invariant_clauses;
+
+/**
+ * A clause of the invariant, the qualified bool() const member function and
+ * the tags of the fields it depends on, e.g. CONTRACT_CLAUSE(Rect::positiveWidth, Width)
+ */
+#define CONTRACT_CLAUSE(method, ...)                                          \
+  ::contract_light::Clause<decltype(&method), &method, __VA_ARGS__>
+
+#define CONTRACT_LIGHT_MODIFIES_ENABLED(...)                                  \
+  typedef ::contract_light::Fields<__VA_ARGS__> contract_light_modified_fields
@@ -0,0 +1,38 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/**
+ * Contract levels. Each contract is tagged with a level and is only compiled
+ * in if its level is less or equal to CONTRACT_LIGHT_LEVEL.
+ * OFF      No contract is compiled in at all
+ * DEFAULT  PRECONDITION, POSTCONDITION and INVARIANT are compiled in
+ * AUDIT    Additionally the expensive *_AUDIT contracts are compiled in
+ */
+#define CONTRACT_LIGHT_LEVEL_OFF     0
+#define CONTRACT_LIGHT_LEVEL_DEFAULT 1
+#define CONTRACT_LIGHT_LEVEL_AUDIT   2
+
+/**
+ * The contract level of the build, e.g. set by -DCONTRACT_LIGHT_LEVEL=0 on the 
+ * command line. It only changes the expansion of the contract makros, so
+ * translation units with different levels can be linked together. But only
+ * their non-inline functions get the level of their translation unit. Of an
+ * inline function or a template that is used by several of them the linker
+ * keeps an arbitrary copy, so all of them must use the same level.
+ */
+#ifndef CONTRACT_LIGHT_LEVEL
+#define CONTRACT_LIGHT_LEVEL CONTRACT_LIGHT_LEVEL_DEFAULT
+#endif
+
+#if CONTRACT_LIGHT_LEVEL < CONTRACT_LIGHT_LEVEL_OFF || CONTRACT_LIGHT_LEVEL > CONTRACT_LIGHT_LEVEL_AUDIT
+#error "CONTRACT_LIGHT_LEVEL must be one of CONTRACT_LIGHT_LEVEL_OFF, _DEFAULT or _AUDIT"
+#endif
@@ -12,6 +12,13 @@
 
 #include "contract_light_helper.hpp"
 #include "contract_light_traits.hpp"
+#include "contract_light_clauses.hpp"
+#include "contract_light_site.hpp"
+#include "contract_light_monitor.hpp"
+#include "contract_light_counters.hpp"
+#include "contract_light_profiler.hpp"
+#include "contract_light_sampling.hpp"
+#include "contract_light_switches.hpp"
 
 namespace contract_light
 {
@@ -22,29 +29,100 @@ namespace contract_light
   {
     namespace contract_detail
     {
-      template <typename T>
+      /**
+       * Everything a guard needs to know about its contract: the object, the
+       * site and the monitor that observes the evaluations of the site
+       */
+      template <typename T, typename Monitor = NoSiteMonitor, typename Modified = AllFields>
       struct ContractContext 
       {
         using provider_type = T;
+        using monitor_type = Monitor;
+        using modified_type = Modified;
         const T& provider;
-        const char* fileName;
-        const int line;
+        const ContractSite& site;
+        Monitor monitor;
 
-        ContractContext(T& p, const char* fn, int ln) : provider(p), fileName(fn), line(ln) {}
+        ContractContext(T& p, const ContractSite& s, const Monitor& m = Monitor()) : provider(p), site(s), monitor(m) {}
       };
 
 
-      template <typename T>
-      struct PreConditionContext : public ContractContext < T >
+      template <typename T, typename Monitor = NoSiteMonitor, typename Modified = AllFields>
+      struct PreConditionContext : public ContractContext < T, Monitor, Modified >
       {
-        PreConditionContext(T& p, const char* fn, int ln) : ContractContext<T>(p, fn, ln) {}
+        PreConditionContext(T& p, const ContractSite& s, const Monitor& m = Monitor()) : ContractContext<T, Monitor, Modified>(p, s, m) {}
       };
 
-      template <typename T>
-      struct PostConditionContext : public ContractContext < T >
+      template <typename T, typename Monitor = NoSiteMonitor, typename Modified = AllFields>
+      struct PostConditionContext : public ContractContext < T, Monitor, Modified >
       {
-        PostConditionContext(T& p, const char* fn, int ln) : ContractContext<T>(p, fn, ln) {}
+        PostConditionContext(T& p, const ContractSite& s, const Monitor& m = Monitor()) : ContractContext<T, Monitor, Modified>(p, s, m) {}
+      };
+
+      template <typename T, typename Monitor = NoSiteMonitor, typename Modified = AllFields>
+      struct ResultConditionContext : public ContractContext < T, Monitor, Modified >
+      {
+        ResultConditionContext(T& p, const ContractSite& s, const Monitor& m = Monitor()) : ContractContext<T, Monitor, Modified>(p, s, m) {}
+      };
+
+      /**
+       * The part of the context that a guard keeps for its lifetime. That is
+       * the site, the monitor and only if the invariant must be checked, the
+       * provider. An empty monitor takes no space, the modified fields are
+       * only a type.
+       */
+      template <typename T, typename Monitor = NoSiteMonitor, typename Modified = AllFields, bool WithProvider = has_invariant<T>::value>
+      struct GuardState : public Monitor
+      {
+        using provider_type = T;
+        using monitor_type = Monitor;
+        using modified_type = Modified;
+        const T& provider;
+        const ContractSite& site;
+
+        explicit GuardState(const ContractContext<T, Monitor, Modified>& ctx) : Monitor(ctx.monitor), provider(ctx.provider), site(ctx.site) {}
+
+        const void* object() const NOEXCEPT {
+          return &provider;
+        }
+      };
+
+      template <typename T, typename Monitor, typename Modified>
+      struct GuardState<T, Monitor, Modified, false> : public Monitor
+      {
+        const ContractSite& site;
+
+        explicit GuardState(const ContractContext<T, Monitor, Modified>& ctx) : Monitor(ctx.monitor), site(ctx.site) {}
+
+        const void* object() const NOEXCEPT {
+          return nullptr;
+        }
       };
     }
   }
-}
\ No newline at end of file
+}
+
+/**
+ * Defines the monitor of the current contract site of the provider object.
+ * It is made of the optional runtime level (CONTRACT_LIGHT_RUNTIME_LEVELS),
+ * the sampling (CONTRACT_LIGHT_SAMPLING), the per site counters
+ * (CONTRACT_LIGHT_COUNTERS) and the predicate profiler
+ * (CONTRACT_LIGHT_PROFILING). Without these defines it does nothing and is
+ * optimized away. The defines only change the expansion of the contract
+ * makros, so only the non-inline functions of a translation unit get its
+ * settings. Inline functions and templates that are used by several
+ * translation units must see the same settings in all of them, otherwise
+ * the linker keeps an arbitrary copy.
+ */
+#define CONTRACT_LIGHT_SITE_MONITOR(name, site, provider)                     \
+  CONTRACT_LIGHT_SWITCH_MONITOR(CONCATENATE(name, _SWITCH), site,             \
+    &::contract_light::contract_detail::class_key<decltype(provider)>::key);  \
+  CONTRACT_LIGHT_SAMPLING_MONITOR(CONCATENATE(name, _SAMPLING), site);        \
+  CONTRACT_LIGHT_COUNTING_MONITOR(CONCATENATE(name, _COUNTING), site);        \
+  CONTRACT_LIGHT_PROFILING_MONITOR(CONCATENATE(name, _PROFILING), site);      \
+  const auto name = ::contract_light::contract_detail::combineMonitors(       \
+    CONCATENATE(name, _SWITCH),                                               \
+    ::contract_light::contract_detail::combineMonitors(                       \
+      CONCATENATE(name, _SAMPLING),                                           \
+      ::contract_light::contract_detail::combineMonitors(                     \
+        CONCATENATE(name, _COUNTING), CONCATENATE(name, _PROFILING))))
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+#include "contract_light_monitor.hpp"
+#include "contract_light_site.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    /**
+     * Merged counters of a single contract site
+     * @evaluations How often the predicate of the site was evaluated
+     * @failures How often the predicate or the invariant failed at this site
+     * @invariantChecks How often the invariant was checked at this site
+     */
+    struct SiteSnapshot
+    {
+      const ContractSite* site;
+      std::uint64_t evaluations;
+      std::uint64_t failures;
+      std::uint64_t invariantChecks;
+    };
+
+    /**
+     * Returns the counters of all sites that were reached so far, sorted by
+     * file and line. The counters of threads that have already finished are
+     * included. It is empty if no translation unit is compiled with
+     * CONTRACT_LIGHT_COUNTERS.
+     */
+    std::vector<SiteSnapshot> snapshot();
+
+    namespace contract_detail
+    {
+      /**
+       * The counters of a single site in a single thread. Each shard is only
+       * written by its own thread, so an increment is an uncontended relaxed
+       * load and store. Zero initialized, so it needs no constructor.
+       */
+      struct SiteCounters
+      {
+        const ContractSite* site; // nullptr until registered
+        SiteCounters* next;       // next shard of the same thread
+        std::atomic<std::uint64_t> evaluations;
+        std::atomic<std::uint64_t> failures;
+        std::atomic<std::uint64_t> invariantChecks;
+      };
+
+      /**
+       * Links the shard into the list that snapshot() merges. On exit of the
+       * thread the shard is folded into the totals of its site.
+       */
+      void registerSiteCounters(const ContractSite& site, SiteCounters& counters);
+
+      inline void increment(std::atomic<std::uint64_t>& counter) NOEXCEPT {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+
+      /**
+       * Counts the evaluations of a site in the shard of the current thread
+       */
+      class CountingSiteMonitor
+      {
+        SiteCounters& _counters;
+      public:
+        CountingSiteMonitor(const ContractSite& site, SiteCounters& counters) : _counters(counters) {
+          if (CONTRACT_LIGHT_UNLIKELY(counters.site == nullptr)) {
+            registerSiteCounters(site, counters);
+          }
+        }
+
+        bool sampled() const NOEXCEPT {
+          return true;
+        }
+
+        template <typename Predicate>
+        bool evaluate(Predicate&& predicate) const {
+          increment(_counters.evaluations);
+          return predicate();
+        }
+
+        template <typename Predicate>
+        bool checkInvariant(Predicate&& predicate) const {
+          increment(_counters.invariantChecks);
+          return predicate();
+        }
+
+        void failed() const NOEXCEPT {
+          increment(_counters.failures);
+        }
+      };
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
+
+/**
+ * Defines the counting part of the site monitor, if CONTRACT_LIGHT_COUNTERS
+ * is defined. It counts the evaluations, failures and invariant checks per
+ * site and thread.
+ */
+#ifdef CONTRACT_LIGHT_COUNTERS
+#define CONTRACT_LIGHT_COUNTING_MONITOR(name, site)                           \
+  static THREAD_LOCAL ::contract_light::contract_detail::SiteCounters CONCATENATE(name, _SHARD); \
+  const ::contract_light::contract_detail::CountingSiteMonitor name(site, CONCATENATE(name, _SHARD))
+#else
+#define CONTRACT_LIGHT_COUNTING_MONITOR(name, site)                           \
+  const ::contract_light::contract_detail::NoSiteMonitor name = {}
+#endif
@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+#include "contract_light_site.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    /**
+     * Function signature to handle failed deferred checks. It is called on
+     * the thread that evaluates the check.
+     * @site The site of the deferred check
+     * @thread The thread that captured the check
+     */
+    using DeferredFailedFunction = void(*)(const ContractSite& site, std::thread::id thread);
+
+    /**
+     * Set a private handler function that gets called whenever a deferred
+     * check is not fulfilled. The function itself must not throw!
+     */
+    void setHandlerFailedDeferred(DeferredFailedFunction) NOEXCEPT;
+
+    /**
+     * Starts a thread that evaluates the deferred checks. Without it the
+     * checks wait in the queue for checkDeferredContracts() and once the
+     * queue is full, further checks are dropped.
+     * @interval The time the thread waits when there are no pending checks
+     */
+    void startDeferredChecker(std::chrono::milliseconds interval = std::chrono::milliseconds(1));
+
+    /**
+     * Stops the checker thread. The pending checks are evaluated before.
+     */
+    void stopDeferredChecker();
+
+    /**
+     * Evaluates all pending deferred checks on the calling thread and returns
+     * their number. It can be used instead of the checker thread.
+     */
+    std::size_t checkDeferredContracts();
+
+    /**
+     * @running If the checker thread is running
+     * @checked The number of evaluated deferred checks
+     * @failed The number of failed deferred checks
+     * @dropped The number of checks that were dropped, because the queue was full
+     */
+    struct DeferredStatus
+    {
+      bool running;
+      std::uint64_t checked;
+      std::uint64_t failed;
+      std::uint64_t dropped;
+    };
+
+    DeferredStatus deferredStatus();
+
+    namespace contract_detail
+    {
+      /**
+       * A captured check in the queue. The predicate, including all values
+       * it captured, is moved into the cell. The sequence tells producers and
+       * the consumer whose turn it is.
+       */
+      struct alignas(64) DeferredCheck
+      {
+        static const std::size_t capacity = 96;
+
+        std::atomic<std::size_t> sequence;
+        const ContractSite* site;
+        std::thread::id thread;
+        bool(*evaluate)(void* predicate);
+        typename std::aligned_storage<capacity, alignof(std::max_align_t)>::type predicate;
+      };
+
+      /**
+       * Preallocated bounded lock-free queue of deferred checks with any
+       * number of producers and a single consumer at a time. A producer never
+       * blocks, if the queue is full the check is dropped and counted.
+       */
+      struct DeferredQueue
+      {
+        static const std::size_t size = 4096;
+
+        DeferredQueue() : enqueuePosition(0), dequeuePosition(0), dropped(0) {
+          for (std::size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+          }
+        }
+
+        DeferredCheck* acquire() NOEXCEPT {
+          auto position = enqueuePosition.load(std::memory_order_relaxed);
+          for (;;) {
+            auto& cell = cells[position & (size - 1)];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+            if (diff == 0) {
+              if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &cell;
+              }
+            }
+            else if (diff < 0) {
+              return nullptr;
+            }
+            else {
+              position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+          }
+        }
+
+        static void publish(DeferredCheck& cell) NOEXCEPT {
+          cell.sequence.store(cell.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        alignas(64) std::atomic<std::size_t> enqueuePosition;
+        alignas(64) std::atomic<std::size_t> dequeuePosition;
+        std::atomic<std::uint64_t> dropped;
+        DeferredCheck cells[size];
+      };
+
+      DeferredQueue& deferredQueue() NOEXCEPT;
+
+      CONTRACT_LIGHT_COLD void handleFailedDeferred(const ContractSite& site, std::thread::id thread) NOEXCEPT;
+
+      template <typename Predicate>
+      bool evaluateDeferred(void* storage) {
+        auto& predicate = *static_cast<Predicate*>(storage);
+        struct Destroy
+        {
+          Predicate& predicate;
+          ~Destroy() { predicate.~Predicate(); }
+        } destroy = { predicate };
+        return predicate();
+      }
+
+      /**
+       * Moves the predicate into the queue. That is the only work on the
+       * calling thread.
+       */
+      template <typename Op>
+      void deferCheck(const ContractSite& site, Op&& op) NOEXCEPT {
+        using Predicate = typename std::decay<Op>::type;
+        static_assert(std::is_same<bool, decltype(op())>::value,
+          "Deferred check must be a callable object returning a boolean");
+        static_assert(sizeof(Predicate) <= DeferredCheck::capacity,
+          "The captures of a deferred check are too large, capture a shared immutable snapshot instead");
+        static_assert(std::is_nothrow_constructible<Predicate, Op&&>::value,
+          "The captures of a deferred check must be movable without exceptions");
+
+        auto& queue = deferredQueue();
+        auto cell = queue.acquire();
+        if (CONTRACT_LIGHT_UNLIKELY(cell == nullptr)) {
+          queue.dropped.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+        new (&cell->predicate) Predicate(std::forward<Op>(op));
+        cell->site = &site;
+        cell->thread = std::this_thread::get_id();
+        cell->evaluate = &evaluateDeferred<Predicate>;
+        DeferredQueue::publish(*cell);
+      }
+
+      template <typename Monitor>
+      struct DeferredContext
+      {
+        const ContractSite& site;
+        Monitor monitor;
+      };
+
+      template <typename Monitor, typename Op>
+      void operator+(DeferredContext<Monitor>&& ctx, Op&& op) NOEXCEPT {
+        if (ctx.monitor.sampled()) {
+          deferCheck(ctx.site, std::forward<Op>(op));
+        }
+      }
+
+      template <typename Monitor>
+      DeferredContext<Monitor> makeDeferredContext(const ContractSite& site, const Monitor& monitor) {
+        return DeferredContext<Monitor>{ site, monitor };
+      }
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+#include "contract_light_site.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    /**
+     * Configuration of the contract governor
+     * @cpuShare The share of the CPU time that contract checking may use
+     * @interval The time between two steps of the governor thread
+     * @maxThrottle The maximum factor by which the sample period of a single
+     *              site is multiplied
+     */
+    struct GovernorConfig
+    {
+      GovernorConfig()
+        : cpuShare(0.02)
+        , interval(std::chrono::milliseconds(100))
+        , maxThrottle(1024)
+      {}
+
+      double cpuShare;
+      std::chrono::milliseconds interval;
+      std::uint32_t maxThrottle;
+    };
+
+    /**
+     * A site whose sample period is currently multiplied by the governor
+     * @throttle The factor of the sample period
+     * @cpuShare The share of the CPU time the site used in the last step
+     */
+    struct ThrottledSite
+    {
+      const ContractSite* site;
+      std::uint32_t throttle;
+      double cpuShare;
+    };
+
+    /**
+     * @running If the governor thread is running
+     * @cpuShare The share of the CPU time all contracts used in the last step
+     * @throttled All throttled sites, the most throttled first
+     */
+    struct GovernorStatus
+    {
+      bool running;
+      double cpuShare;
+      std::vector<ThrottledSite> throttled;
+    };
+
+    /**
+     * Starts a thread that limits the CPU time spent in contract checking.
+     * Whenever the contracts use more than the configured share of the
+     * process CPU time, the sample periods of the costliest sites are
+     * doubled. When the load drops, they are halved again. Only sites that
+     * are compiled with CONTRACT_LIGHT_PROFILING and CONTRACT_LIGHT_SAMPLING
+     * are measured and throttled.
+     */
+    void startGovernor(const GovernorConfig& config = GovernorConfig());
+
+    /**
+     * Stops the governor thread. The sites keep their current throttle.
+     */
+    void stopGovernor();
+
+    /**
+     * Runs a single step of the governor, for the given CPU time in ticks of
+     * the profiler that passed since the last step. It is called by the
+     * governor thread, but it can be driven manually instead, e.g. from an
+     * existing timer.
+     */
+    void governContracts(std::uint64_t cpuTicks, const GovernorConfig& config = GovernorConfig());
+
+    /**
+     * Removes the throttle of all sites
+     */
+    void resetGovernor();
+
+    /**
+     * Returns the current decisions of the governor
+     */
+    GovernorStatus governorStatus();
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
@@ -11,6 +11,8 @@
 
 #define CONCATENATE_IMPL(s1, s2) s1##s2
 #define CONCATENATE(s1, s2) CONCATENATE_IMPL(s1, s2)
+#define STRINGIFY_IMPL(s) #s
+#define STRINGIFY(s) STRINGIFY_IMPL(s)
 #ifdef __COUNTER__
 #define ANONYMOUS_VARIABLE(str) \
 CONCATENATE(str, __COUNTER__)
@@ -22,12 +24,33 @@ CONCATENATE(str, __LINE__)
 #ifdef _MSC_VER 
 #if _MSC_VER < 1900
 #define NOEXCEPT throw()
+#define CONSTEXPR
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define NOEXCEPT noexcept
+#define CONSTEXPR constexpr
+#define THREAD_LOCAL thread_local
 #endif
 #if _MSC_VER > 1900
 #define HAS_INLINE_NAMESPACE
 #endif
 #else
 #define NOEXCEPT noexcept
+#define CONSTEXPR constexpr
+#define THREAD_LOCAL thread_local
 #define HAS_INLINE_NAMESPACE
 #endif
 
+
+/**
+ * Contract failures are the exception, so the compiler shall move the
+ * failure handling out of the hot path, e.g. into .text.unlikely.
+ * Defining CONTRACT_LIGHT_NO_BRANCH_HINTS disables this.
+ */
+#if defined(__GNUC__) && !defined(CONTRACT_LIGHT_NO_BRANCH_HINTS)
+#define CONTRACT_LIGHT_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define CONTRACT_LIGHT_COLD __attribute__((cold, noinline))
+#else
+#define CONTRACT_LIGHT_UNLIKELY(x) (x)
+#define CONTRACT_LIGHT_COLD
+#endif
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    struct ViolationInfo;
+
+    /**
+     * A violation handler that appends a fixed size binary record to a ring
+     * of the current thread. It never blocks and does no I/O. If the ring is
+     * full, the record is dropped and counted. It can be set with
+     * setViolationHandler for any contract kind.
+     */
+    void logViolation(const ViolationInfo& info) NOEXCEPT;
+
+    /**
+     * Opens the file for appending, writes a session with all contract sites
+     * and the executable mappings of /proc/self/maps, and starts a thread
+     * that moves the records from the rings to the file. Each session is
+     * appended, so the file can be kept across runs. Libraries that are
+     * loaded after the start can not be symbolized.
+     * @interval The time the thread waits between two flushes
+     * @return false, if the file cannot be opened
+     */
+    bool startViolationLog(const char* path, std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+
+    /**
+     * Stops the thread, writes the pending records and closes the file
+     */
+    void stopViolationLog();
+
+    /**
+     * @running If a log file is open
+     * @written The number of records written to the file
+     * @dropped The number of records that were dropped, because the ring of their thread was full
+     */
+    struct ViolationLogStatus
+    {
+      bool running;
+      std::uint64_t written;
+      std::uint64_t dropped;
+    };
+
+    ViolationLogStatus violationLogStatus();
+
+    /**
+     * Writes the records of a violation log as text, one line per record,
+     * with the sites of their session, followed by one line per frame of the
+     * call stack. Used by contract_light_decode.
+     * @symbolize If true, the frames are looked up in the symbol tables of
+     *            the mapped ELF files, otherwise only the file and the offset
+     *            are printed
+     * @return The number of decoded records
+     */
+    std::size_t decodeViolationLog(std::istream& log, std::ostream& text, bool symbolize = true);
+
+    /**
+     * Returns the demangled name of the function that contains the offset in
+     * the ELF file, with the distance to its start, e.g. "foo(int)+0x1c". It
+     * is empty, if the file or the symbol can not be found. The symbol tables
+     * are cached, so it is meant for offline tools.
+     */
+    std::string symbolizeFrame(const std::string& file, std::uint64_t fileOffset);
+
+    namespace contract_detail
+    {
+      /**
+       * The file is a sequence of blocks in the byte order of the writer.
+       * Session  LogSession, followed by one Site block per contract site
+       *          and a Maps block
+       * Site     LogSite, followed by the file name, function and expression
+       * Maps     The executable lines of /proc/self/maps
+       * Records  LogSync, followed by LogRecords
+       */
+      enum class LogBlockTag : std::uint32_t
+      {
+        Session = 0x4e534c43, // "CLSN"
+        Site = 0x54534c43,    // "CLST"
+        Maps = 0x504d4c43,    // "CLMP"
+        Records = 0x54524c43  // "CLRT"
+      };
+
+      struct LogBlock
+      {
+        LogBlockTag tag;
+        std::uint32_t size; // of the following payload
+      };
+
+      struct LogSession
+      {
+        static const std::uint32_t currentVersion = 2;
+
+        std::uint32_t version;
+        std::uint32_t recordSize;
+        std::int64_t wallNanoseconds;
+        std::uint64_t ticks;
+      };
+
+      struct LogSite
+      {
+        std::uint64_t id;
+        std::uint8_t kind;
+        std::uint8_t level;
+        std::uint16_t reserved;
+        std::int32_t line;
+        std::uint32_t fileNameLength;
+        std::uint32_t functionLength;
+        std::uint32_t expressionLength;
+        std::uint32_t reserved2;
+      };
+
+      /**
+       * The wall clock and the cycle counter at the flush, so the decoder
+       * can convert the ticks of the records
+       */
+      struct LogSync
+      {
+        std::int64_t wallNanoseconds;
+        std::uint64_t ticks;
+      };
+
+      /**
+       * The decoder accepts records of other sizes, missing fields are 0
+       */
+      struct LogRecord
+      {
+        static const std::uint32_t maxFrames = 16;
+
+        std::uint64_t siteId;
+        std::uint64_t ticks;
+        std::uint64_t thread;
+        std::uint64_t object;
+        std::uint32_t kind;
+        std::uint32_t frameCount;
+        std::uint64_t frames[maxFrames];
+      };
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+
+#include <utility>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    namespace contract_detail
+    {
+      /**
+       * A site monitor observes the evaluations of a single contract site.
+       * The guards evaluate the predicate and the invariant through it and
+       * report failures to it. If the current call is not sampled, also
+       * the old values of a postcondition are not captured. This one does
+       * nothing, so it is optimized away and as empty base of the guard state
+       * it takes no space.
+       */
+      struct NoSiteMonitor
+      {
+        bool sampled() const NOEXCEPT {
+          return true;
+        }
+
+        template <typename Predicate>
+        bool evaluate(Predicate&& predicate) const {
+          return predicate();
+        }
+
+        template <typename Predicate>
+        bool checkInvariant(Predicate&& predicate) const {
+          return predicate();
+        }
+
+        void failed() const NOEXCEPT {}
+      };
+
+      /**
+       * Combines two monitors, the outer one observes the inner one
+       */
+      template <typename Outer, typename Inner>
+      struct SiteMonitors : public Outer, public Inner
+      {
+        SiteMonitors(const Outer& outer, const Inner& inner) : Outer(outer), Inner(inner) {}
+
+        bool sampled() const NOEXCEPT {
+          return Outer::sampled() && Inner::sampled();
+        }
+
+        template <typename Predicate>
+        bool evaluate(Predicate&& predicate) const {
+          return Outer::evaluate([&] { return Inner::evaluate(predicate); });
+        }
+
+        template <typename Predicate>
+        bool checkInvariant(Predicate&& predicate) const {
+          return Outer::checkInvariant([&] { return Inner::checkInvariant(predicate); });
+        }
+
+        void failed() const NOEXCEPT {
+          Outer::failed();
+          Inner::failed();
+        }
+      };
+
+      template <typename Outer, typename Inner>
+      SiteMonitors<Outer, Inner> combineMonitors(const Outer& outer, const Inner& inner) {
+        return SiteMonitors<Outer, Inner>(outer, inner);
+      }
+
+      template <typename Outer>
+      Outer combineMonitors(const Outer& outer, NoSiteMonitor) {
+        return outer;
+      }
+
+      template <typename Inner>
+      Inner combineMonitors(NoSiteMonitor, const Inner& inner) {
+        return inner;
+      }
+
+      inline NoSiteMonitor combineMonitors(NoSiteMonitor, NoSiteMonitor) {
+        return NoSiteMonitor();
+      }
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+
+#include <new>
+#include <type_traits>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    namespace contract_detail
+    {
+      /**
+       * Marks, if OLD values are declared in the current scope that the
+       * following postcondition has to capture
+       */
+      struct WithoutOlds {};
+      struct WithOlds {};
+
+      /**
+       * An old value that waits for its postcondition. The pending ones of a
+       * thread form a list, the most recent one first.
+       */
+      struct OldSlot
+      {
+        OldSlot* next;
+        void(*capture)(OldSlot&);
+      };
+
+      inline OldSlot*& pendingOlds() NOEXCEPT {
+        static THREAD_LOCAL OldSlot* head;
+        return head;
+      }
+
+      /**
+       * Takes all pending old values of this thread, which are the ones
+       * declared right before the postcondition, and captures them if the
+       * postcondition is sampled. So the old values of a postcondition that is
+       * not sampled are not left behind for the postcondition of a callee.
+       */
+      template <typename Monitor>
+      void captureOlds(WithOlds, const Monitor& monitor) {
+        auto& head = pendingOlds();
+        auto slot = head;
+        head = nullptr;
+        if (!monitor.sampled()) {
+          return;
+        }
+        while (slot) {
+          auto next = slot->next;
+          slot->capture(*slot);
+          slot = next;
+        }
+      }
+
+      template <typename Monitor>
+      void captureOlds(WithoutOlds, const Monitor&) NOEXCEPT {}
+
+      template <typename E>
+      using old_type = typename std::decay<E>::type;
+
+      /**
+       * Holds the value of an expression at the entry of a function. It is
+       * evaluated by the following postcondition, so it is not evaluated if
+       * the postcondition is not sampled. The value is constructed in place
+       * from the result of the expression, so no further copy is made. As the
+       * slot is linked by its address, it can be neither copied nor moved.
+       */
+      template <typename T, typename Expression>
+      class OldValue : private OldSlot
+      {
+        const Expression& _expression;
+        typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type _storage;
+        bool _captured;
+
+        static void captureValue(OldSlot& slot) {
+          auto& self = static_cast<OldValue&>(slot);
+          new (&self._storage) T(self._expression());
+          self._captured = true;
+        }
+
+      public:
+        explicit OldValue(const Expression& expression) : _expression(expression), _captured(false) {
+          auto& head = pendingOlds();
+          next = head;
+          capture = &captureValue;
+          head = this;
+        }
+
+        OldValue(const OldValue&) = delete;
+        OldValue& operator=(const OldValue&) = delete;
+
+        ~OldValue() {
+          auto& head = pendingOlds();
+          if (head == this) {
+            head = next;
+          }
+          if (_captured) {
+            get().~T();
+          }
+        }
+
+        bool captured() const NOEXCEPT {
+          return _captured;
+        }
+
+        const T& get() const NOEXCEPT {
+          return *reinterpret_cast<const T*>(&_storage);
+        }
+
+        const T& operator*() const NOEXCEPT {
+          return get();
+        }
+
+        const T* operator->() const NOEXCEPT {
+          return &get();
+        }
+      };
+
+      /**
+       * Stands for an old value of a disabled postcondition. It is only
+       * referenced from never evaluated checks, so the accessors are not
+       * defined.
+       */
+      template <typename T>
+      struct DisabledOld
+      {
+        bool captured() const NOEXCEPT {
+          return false;
+        }
+
+        const T& get() const NOEXCEPT;
+        const T& operator*() const NOEXCEPT;
+        const T* operator->() const NOEXCEPT;
+      };
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
+
+/**
+ * Outside of a scope with OLD values, a postcondition has nothing to capture
+ */
+typedef ::contract_light::contract_detail::WithoutOlds contract_light_olds_in_scope;
+
+#define CONTRACT_LIGHT_OLD_ENABLED(name, expr)                                \
+  typedef ::contract_light::contract_detail::WithOlds contract_light_olds_in_scope; \
+  const auto CONCATENATE(name, _EXPRESSION) = [&] { return expr; };           \
+  const ::contract_light::contract_detail::OldValue<                          \
+    ::contract_light::contract_detail::old_type<decltype(expr)>,              \
+    decltype(CONCATENATE(name, _EXPRESSION))> name(CONCATENATE(name, _EXPRESSION))
+
+#define CONTRACT_LIGHT_OLD_DISABLED(name, expr)                               \
+  const ::contract_light::contract_detail::DisabledOld<                       \
+    ::contract_light::contract_detail::old_type<decltype(expr)>> name = {}
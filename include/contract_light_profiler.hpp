@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+#include "contract_light_monitor.hpp"
+#include "contract_light_site.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif !defined(__x86_64__) && !defined(__i386__) && !defined(__aarch64__)
+#include <time.h>
+#endif
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    /**
+     * Evaluation cost of a single contract site, in ticks of the cycle
+     * counter (time stamp counter on x86, virtual counter on AArch64) or in
+     * nanoseconds on other platforms
+     * @evaluations Number of timed predicate and invariant evaluations
+     * @totalTicks Sum of the cost of all evaluations
+     * @p99Ticks Upper bound of the 99th percentile of the cost of a single
+     *           evaluation. The histogram has power of two buckets, so it is
+     *           less than twice the exact value.
+     */
+    struct SiteCost
+    {
+      const ContractSite* site;
+      std::uint64_t evaluations;
+      std::uint64_t totalTicks;
+      std::uint64_t p99Ticks;
+    };
+
+    enum class CostOrder
+    {
+      Total,
+      P99
+    };
+
+    /**
+     * Returns the n most expensive contract sites, ordered by their total or
+     * their p99 cost. The evaluations of finished threads are included. It
+     * is empty if no translation unit is compiled with CONTRACT_LIGHT_PROFILING.
+     */
+    std::vector<SiteCost> mostExpensiveSites(std::size_t n, CostOrder order = CostOrder::Total);
+
+    namespace contract_detail
+    {
+      /**
+       * Returns the cycle counter, or the monotonic clock in nanoseconds on
+       * platforms without one
+       */
+      inline std::uint64_t readTicks() NOEXCEPT {
+#if defined(_MSC_VER)
+        return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+        std::uint64_t ticks;
+        __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<std::uint64_t>(now.tv_sec) * 1000000000u + now.tv_nsec;
+#endif
+      }
+
+      /**
+       * The cost histogram of a single site in a single thread. Bucket i
+       * counts the evaluations that took less than 2^i ticks, but not less
+       * than 2^(i-1). As the counters it is only written by its own thread.
+       */
+      struct SiteProfile
+      {
+        static const int buckets = 64;
+
+        const ContractSite* site; // nullptr until registered
+        SiteProfile* next;        // next shard of the same thread
+        std::atomic<std::uint64_t> totalTicks;
+        std::atomic<std::uint64_t> histogram[buckets];
+      };
+
+      void registerSiteProfile(const ContractSite& site, SiteProfile& profile);
+
+      inline int costBucket(std::uint64_t ticks) NOEXCEPT {
+#if defined(__GNUC__)
+        const int bucket = ticks == 0 ? 0 : 64 - __builtin_clzll(ticks);
+        return bucket < SiteProfile::buckets ? bucket : SiteProfile::buckets - 1;
+#else
+        int bucket = 0;
+        for (; ticks != 0 && bucket < SiteProfile::buckets - 1; ticks >>= 1) {
+          ++bucket;
+        }
+        return bucket;
+#endif
+      }
+
+      /**
+       * Times every evaluation of a site and adds it to the histogram of the
+       * current thread
+       */
+      class ProfilingSiteMonitor
+      {
+        SiteProfile& _profile;
+
+        template <typename Predicate>
+        bool timed(Predicate&& predicate) const {
+          const auto start = readTicks();
+          const bool result = predicate();
+          const auto ticks = readTicks() - start;
+          auto& total = _profile.totalTicks;
+          total.store(total.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+          auto& bucket = _profile.histogram[costBucket(ticks)];
+          bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+          return result;
+        }
+
+      public:
+        ProfilingSiteMonitor(const ContractSite& site, SiteProfile& profile) : _profile(profile) {
+          if (CONTRACT_LIGHT_UNLIKELY(profile.site == nullptr)) {
+            registerSiteProfile(site, profile);
+          }
+        }
+
+        bool sampled() const NOEXCEPT {
+          return true;
+        }
+
+        template <typename Predicate>
+        bool evaluate(Predicate&& predicate) const {
+          return timed(predicate);
+        }
+
+        template <typename Predicate>
+        bool checkInvariant(Predicate&& predicate) const {
+          return timed(predicate);
+        }
+
+        void failed() const NOEXCEPT {}
+      };
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
+
+/**
+ * Defines the profiling part of the site monitor, if CONTRACT_LIGHT_PROFILING
+ * is defined. It times every predicate and invariant evaluation of the site.
+ */
+#ifdef CONTRACT_LIGHT_PROFILING
+#define CONTRACT_LIGHT_PROFILING_MONITOR(name, site)                          \
+  static THREAD_LOCAL ::contract_light::contract_detail::SiteProfile CONCATENATE(name, _SHARD); \
+  const ::contract_light::contract_detail::ProfilingSiteMonitor name(site, CONCATENATE(name, _SHARD))
+#else
+#define CONTRACT_LIGHT_PROFILING_MONITOR(name, site)                          \
+  const ::contract_light::contract_detail::NoSiteMonitor name = {}
+#endif
@@ -0,0 +1,172 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+#include "contract_light_monitor.hpp"
+#include "contract_light_site.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    /**
+     * Countdown  Exactly every n-th call of a site on a thread is checked
+     * Random     Every call is checked with the probability 1/n, so periodic
+     *            call patterns cannot hide a failure
+     */
+    enum class SamplingMode : unsigned char
+    {
+      Countdown,
+      Random
+    };
+
+    /**
+     * Sets the sample rate of all sites without an own rate. With a period
+     * of n only one of n calls of a site is checked. The default is 1, so
+     * every call is checked. Only sites compiled with CONTRACT_LIGHT_SAMPLING
+     * are sampled.
+     */
+    void setSampleRate(std::uint32_t period, SamplingMode mode = SamplingMode::Countdown);
+
+    /**
+     * Sets the sample rate of a single site, identified by ContractSite::id
+     */
+    void setSiteSampleRate(std::uint64_t siteId, std::uint32_t period, SamplingMode mode = SamplingMode::Countdown);
+
+    /**
+     * The site uses the global sample rate again
+     */
+    void resetSiteSampleRate(std::uint64_t siteId);
+
+    namespace contract_detail
+    {
+      /**
+       * The current sample rate of a site, shared by all threads. The lower
+       * bits are the period, the highest bit selects the random mode. It is
+       * zero until the site is registered.
+       */
+      struct SiteSampling
+      {
+        static const std::uint32_t randomMode = 0x80000000u;
+        static const std::uint32_t maxPeriod = 0x7fffffffu;
+
+        std::atomic<std::uint32_t> rate;
+      };
+
+      /**
+       * Registers the site for rate updates and returns its current rate
+       */
+      std::uint32_t registerSiteSampling(const ContractSite& site, SiteSampling& sampling);
+
+      /**
+       * Multiplies the sample period of the site by the factor, used by the
+       * governor. A factor of 1 removes the throttle.
+       */
+      void setSiteThrottle(std::uint64_t siteId, std::uint32_t factor);
+
+      /**
+       * Returns a non zero seed for the random generator of the current thread
+       */
+      std::uint32_t samplingSeed() NOEXCEPT;
+
+      /**
+       * One of period calls is sampled. If the period was lowered in between,
+       * the remaining calls are cut short.
+       */
+      inline bool sampleCountdown(std::uint32_t period, std::uint32_t& remaining) NOEXCEPT {
+        if (remaining > 1 && remaining <= period) {
+          --remaining;
+          return false;
+        }
+        remaining = period;
+        return true;
+      }
+
+      /**
+       * Each call is sampled with the probability 1/period, decided by a per
+       * thread xorshift generator
+       */
+      inline bool sampleRandomly(std::uint32_t period) NOEXCEPT {
+        static THREAD_LOCAL std::uint32_t state;
+        auto x = state;
+        if (CONTRACT_LIGHT_UNLIKELY(x == 0)) {
+          x = samplingSeed();
+        }
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state = x;
+        return ((static_cast<std::uint64_t>(x) * period) >> 32) == 0;
+      }
+
+      /**
+       * Decides on construction whether the current call of the site is
+       * sampled. A call that is not sampled evaluates neither the predicate
+       * nor the invariant.
+       */
+      class SamplingSiteMonitor
+      {
+        bool _sampled;
+      public:
+        SamplingSiteMonitor(const ContractSite& site, SiteSampling& sampling, std::uint32_t& remaining) {
+          auto rate = sampling.rate.load(std::memory_order_relaxed);
+          if (CONTRACT_LIGHT_UNLIKELY(rate == 0)) {
+            rate = registerSiteSampling(site, sampling);
+          }
+          _sampled = (rate & SiteSampling::randomMode) != 0
+            ? sampleRandomly(rate & SiteSampling::maxPeriod)
+            : sampleCountdown(rate, remaining);
+        }
+
+        bool sampled() const NOEXCEPT {
+          return _sampled;
+        }
+
+        template <typename Predicate>
+        bool evaluate(Predicate&& predicate) const {
+          return !_sampled || predicate();
+        }
+
+        template <typename Predicate>
+        bool checkInvariant(Predicate&& predicate) const {
+          return !_sampled || predicate();
+        }
+
+        void failed() const NOEXCEPT {}
+      };
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
+
+/**
+ * Defines the sampling part of the site monitor, if CONTRACT_LIGHT_SAMPLING
+ * is defined. It is the outermost monitor, so calls that are not sampled are
+ * neither counted nor profiled.
+ */
+#ifdef CONTRACT_LIGHT_SAMPLING
+#define CONTRACT_LIGHT_SAMPLING_MONITOR(name, site)                           \
+  static ::contract_light::contract_detail::SiteSampling CONCATENATE(name, _RATE); \
+  static THREAD_LOCAL std::uint32_t CONCATENATE(name, _COUNTDOWN);            \
+  const ::contract_light::contract_detail::SamplingSiteMonitor name(site, CONCATENATE(name, _RATE), CONCATENATE(name, _COUNTDOWN))
+#else
+#define CONTRACT_LIGHT_SAMPLING_MONITOR(name, site)                           \
+  const ::contract_light::contract_detail::NoSiteMonitor name = {}
+#endif
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_helper.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * On ELF platforms the address of every contract site is additionally
+ * emitted into the section contract_light_sites, so that all sites can be
+ * enumerated via the linker generated __start_/__stop_ symbols.
+ * The address must be a link time constant for this, so code compiled for a
+ * shared library (-fPIC, but not -fPIE) does not register its sites.
+ */
+#if defined(__ELF__) && defined(__GNUC__) && (defined(__x86_64__) || defined(__aarch64__))
+#define CONTRACT_LIGHT_HAS_SITE_TABLE
+#endif
+
+#if defined(CONTRACT_LIGHT_HAS_SITE_TABLE) && (!defined(__PIC__) || defined(__PIE__)) && \
+    !defined(CONTRACT_LIGHT_NO_SITE_TABLE)
+#define CONTRACT_LIGHT_REGISTERS_SITES
+#define CONTRACT_LIGHT_REGISTER_SITE(site)                                    \
+  __asm__ __volatile__(".pushsection contract_light_sites,\"aw\"\n\t"        \
+                       ".balign 8\n\t"                                        \
+                       ".quad %c0\n\t"                                        \
+                       ".popsection" : : "i"(&site))
+#else
+#define CONTRACT_LIGHT_REGISTER_SITE(site) static_cast<void>(0)
+#endif
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    enum class ContractKind : unsigned char
+    {
+      PreCondition,
+      PostCondition,
+      Invariant,
+      Deferred
+    };
+
+    /**
+     * Static descriptor of a single contract site. Every contract makro
+     * emits exactly one constant initialized instance, so it costs nothing
+     * at startup. Its address identifies the site within the process, the
+     * id identifies the site by its file, line, kind and level across runs.
+     * All instantiations of a site in a template share its id.
+     */
+    struct ContractSite
+    {
+      ContractKind kind;
+      unsigned char level;
+      int line;
+      std::uint64_t id;
+      const char* fileName;
+      const char* function;
+      const char* expression; // nullptr for pre- and postconditions
+    };
+
+    /**
+     * Returns all registered contract sites of the program sorted by file and
+     * line. It is empty on platforms without a site table.
+     */
+    std::vector<const ContractSite*> contractSites();
+
+    namespace contract_detail
+    {
+      /**
+       * FNV-1a hash of a string, continuing the given hash
+       */
+      inline CONSTEXPR std::uint64_t fnv1a(const char* text, std::uint64_t hash = 14695981039346656037ull) {
+        return *text == 0
+          ? hash
+          : fnv1a(text + 1, (hash ^ static_cast<unsigned char>(*text)) * 1099511628211ull);
+      }
+
+      /**
+       * Hash of the file name and the name of the site's descriptor, which
+       * encodes the kind, the level and the line of the contract
+       */
+      inline CONSTEXPR std::uint64_t siteId(const char* fileName, const char* siteName) {
+        return fnv1a(siteName, fnv1a(fileName));
+      }
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
+
+/**
+ * Names the variables of a contract site after its kind, its level and the
+ * line. The name must not depend on the translation unit, e.g. through
+ * __COUNTER__, because a site in an inline function must be the same object
+ * in all translation units. So at most one contract of each kind and level
+ * can be written per line.
+ */
+#define CONTRACT_LIGHT_SITE_TAG(kind, level) CONCATENATE(CONCATENATE(kind, level), CONCATENATE(_L, __LINE__))
+
+/**
+ * Defines the static descriptor of the current contract site and registers
+ * it in the site table
+ */
+#define CONTRACT_LIGHT_SITE(name, kind, level, expression)                    \
+  static CONSTEXPR const ::contract_light::ContractSite name = {              \
+    kind, level, __LINE__,                                                    \
+    ::contract_light::contract_detail::siteId(__FILE__, STRINGIFY(name)),     \
+    __FILE__, __func__, expression };                                         \
+  CONTRACT_LIGHT_REGISTER_SITE(name)
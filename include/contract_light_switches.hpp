@@ -0,0 +1,289 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "contract_light_config.hpp"
+#include "contract_light_helper.hpp"
+#include "contract_light_monitor.hpp"
+#include "contract_light_site.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace contract_light
+{
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100
+  {
+    /**
+     * Sets the runtime level of all sites without a more specific level. A
+     * site is only checked if its level is less or equal to its runtime
+     * level, e.g. with CONTRACT_LIGHT_LEVEL_DEFAULT the *_AUDIT contracts are
+     * skipped. The default is CONTRACT_LIGHT_LEVEL_AUDIT, so every compiled
+     * contract is checked. Only sites compiled with
+     * CONTRACT_LIGHT_RUNTIME_LEVELS have a runtime level.
+     * Only the guards read the levels lock free. This and the other level
+     * setters are serialized by a mutex and rewrite the switches of all
+     * registered sites, so they are meant for rare reconfiguration.
+     */
+    void setContractLevel(int level);
+
+    /**
+     * Sets the runtime level of all sites in namespaces tagged with
+     * CONTRACT_MODULE(module)
+     */
+    void setModuleContractLevel(const char* module, int level);
+
+    /**
+     * The sites of the module use the global level again
+     */
+    void resetModuleContractLevel(const char* module);
+
+    /**
+     * Sets the runtime level of a single site, identified by ContractSite::id.
+     * It takes precedence over the class, the module and the global level.
+     */
+    void setSiteContractLevel(std::uint64_t siteId, int level);
+
+    /**
+     * The site uses the level of its class, its module or the global one again
+     */
+    void resetSiteContractLevel(std::uint64_t siteId);
+
+    /**
+     * @points The number of patch points of sites compiled with
+     *         CONTRACT_LIGHT_STATIC_KEYS, zero on other platforms
+     * @enabled The number of patch points that currently jump to their check
+     * @failures The number of patches that failed, because the code could not
+     *           be made writable, e.g. by a W^X policy. Such sites keep their
+     *           previous state.
+     */
+    struct StaticKeyStatus
+    {
+      std::size_t points;
+      std::size_t enabled;
+      std::size_t failures;
+    };
+
+    StaticKeyStatus staticKeyStatus();
+
+    namespace contract_detail
+    {
+      /**
+       * The type independent key of a class, its address is unique per type
+       */
+      template <typename T>
+      struct ClassKey
+      {
+        static const char key;
+      };
+
+      template <typename T>
+      const char ClassKey<T>::key = 0;
+
+      /**
+       * The key of the class of a provider expression, e.g. *this
+       */
+      template <typename T>
+      using class_key = ClassKey<typename std::decay<T>::type>;
+
+      void setClassContractLevel(const void* classKey, int level);
+      void resetClassContractLevel(const void* classKey);
+
+      /**
+       * The resolved runtime level of a site plus one, shared by all threads.
+       * It is zero until the site is registered. It is a function local
+       * static of the site, so where it lands in memory is up to the
+       * compiler; it is not packed with the switches of other sites.
+       * Only the guards read it lock free. The setters of the levels take a
+       * mutex and rewrite the switches of all registered sites.
+       */
+      struct SiteSwitch
+      {
+        std::atomic<std::uint8_t> level;
+      };
+
+      /**
+       * Registers the site for level updates and returns its current switch
+       * value
+       * @classKey The class of the provider or nullptr
+       * @module The name of the module of the site or nullptr
+       */
+      std::uint8_t registerSiteSwitch(const ContractSite& site, SiteSwitch& siteSwitch,
+                                      const void* classKey, const char* module);
+
+      /**
+       * Decides on construction whether the site is switched on. A switched
+       * off site evaluates neither the predicate nor the invariant and does not
+       * take part in the invariant nesting. The site level is a compile time
+       * constant, so it costs one load and one branch.
+       */
+      class SwitchSiteMonitor
+      {
+        bool _enabled;
+      public:
+        SwitchSiteMonitor(const ContractSite& site, SiteSwitch& siteSwitch, const void* classKey, const char* module) {
+          auto level = siteSwitch.level.load(std::memory_order_relaxed);
+          if (CONTRACT_LIGHT_UNLIKELY(level == 0)) {
+            level = registerSiteSwitch(site, siteSwitch, classKey, module);
+          }
+          _enabled = site.level < level;
+        }
+
+        /**
+         * The site was already switched by its patch point
+         */
+        explicit SwitchSiteMonitor(bool enabled) NOEXCEPT : _enabled(enabled) {}
+
+        bool sampled() const NOEXCEPT {
+          return _enabled;
+        }
+
+        template <typename Predicate>
+        bool evaluate(Predicate&& predicate) const {
+          return !_enabled || predicate();
+        }
+
+        template <typename Predicate>
+        bool checkInvariant(Predicate&& predicate) const {
+          return !_enabled || predicate();
+        }
+
+        void failed() const NOEXCEPT {}
+      };
+
+      /**
+       * Tells the invariant policy if the site of a guard is switched on. The
+       * switch is always the outermost monitor, so without it every site is.
+       */
+      template <typename Monitor>
+      bool switchedOn(const Monitor&) NOEXCEPT {
+        return true;
+      }
+
+      inline bool switchedOn(const SwitchSiteMonitor& monitor) NOEXCEPT {
+        return monitor.sampled();
+      }
+
+      template <typename Inner>
+      bool switchedOn(const SiteMonitors<SwitchSiteMonitor, Inner>& monitor) NOEXCEPT {
+        return monitor.SwitchSiteMonitor::sampled();
+      }
+    }
+
+    /**
+     * Sets the runtime level of all sites guarding objects of the class. It
+     * takes precedence over the module and the global level.
+     */
+    template <typename Class>
+    void setClassContractLevel(int level) {
+      contract_detail::setClassContractLevel(&contract_detail::ClassKey<Class>::key, level);
+    }
+
+    /**
+     * The sites of the class use the level of their module or the global one again
+     */
+    template <typename Class>
+    void resetClassContractLevel() {
+      contract_detail::resetClassContractLevel(&contract_detail::ClassKey<Class>::key);
+    }
+  }
+#ifndef HAS_INLINE_NAMESPACE
+  using namespace v_100;
+#endif
+}
+
+/**
+ * Sites outside of a tagged namespace belong to no module
+ */
+struct contract_light_module_tag
+{
+  static const char* name() { return nullptr; }
+};
+
+/**
+ * Tags the enclosing namespace as module for the runtime levels, e.g.
+ * namespace network { CONTRACT_MODULE("network"); }. All sites in member
+ * functions of the namespace and its nested namespaces belong to it. It must
+ * be the same in all translation units, so it is best placed in a common
+ * header.
+ */
+#define CONTRACT_MODULE(module)                                               \
+  struct contract_light_module_tag                                            \
+  {                                                                           \
+    static const char* name() { return module; }                              \
+  }
+
+/**
+ * With CONTRACT_LIGHT_STATIC_KEYS on Linux x86-64 and AArch64 each site is
+ * switched by a patch point in the code instead of its byte. It is a jump to
+ * the check while the site is on and a NOP while it is off, so a switched
+ * off site loads no level. The guard is still constructed and tests the
+ * state taken from the patch point, like the one of the byte. The patch
+ * points are collected in the linker section contract_light_patch_points
+ * and rewritten when a level changes. A patch point is emitted into the
+ * section group of its function, so it is discarded together with a
+ * discarded copy of an inline function.
+ * On x86-64 a patch point is 8 byte aligned, so it is rewritten with a
+ * single atomic store while other threads execute it.
+ */
+#if defined(CONTRACT_LIGHT_REGISTERS_SITES) && defined(__linux__)
+#define CONTRACT_LIGHT_HAS_STATIC_KEYS
+#endif
+
+#if defined(CONTRACT_LIGHT_STATIC_KEYS) && defined(CONTRACT_LIGHT_HAS_STATIC_KEYS)
+#define CONTRACT_LIGHT_USES_STATIC_KEYS
+#if defined(__x86_64__)
+#define CONTRACT_LIGHT_PATCH_INSTRUCTION                                      \
+  ".balign 8\n\t"                                                             \
+  "1: .byte 0xe9\n\t"                                                         \
+  ".long %l3 - 2f\n\t"                                                        \
+  "2:\n\t"
+#else
+#define CONTRACT_LIGHT_PATCH_INSTRUCTION                                      \
+  "1: b %l3\n\t"
+#endif
+#define CONTRACT_LIGHT_PATCH_POINT(site, classKey, label)                     \
+  __asm__ goto(CONTRACT_LIGHT_PATCH_INSTRUCTION                               \
+               ".pushsection contract_light_patch_points,\"aw?\"\n\t"        \
+               ".balign 8\n\t"                                                \
+               ".quad 1b, %l3, %c0, %c1, %c2\n\t"                             \
+               ".popsection"                                                  \
+               : : "i"(&site), "i"(classKey), "i"(&contract_light_module_tag::name) : : label)
+#endif
+
+/**
+ * Defines the runtime level part of the site monitor, if
+ * CONTRACT_LIGHT_RUNTIME_LEVELS or CONTRACT_LIGHT_STATIC_KEYS is defined. It
+ * is the outermost monitor, so switched off sites are neither sampled,
+ * counted nor profiled.
+ */
+#if defined(CONTRACT_LIGHT_USES_STATIC_KEYS)
+#define CONTRACT_LIGHT_SWITCH_MONITOR(monitor, site, classKey)                \
+  bool CONCATENATE(monitor, _ENABLED) = false;                                \
+  CONTRACT_LIGHT_PATCH_POINT(site, classKey, CONCATENATE(monitor, _ON));      \
+  if (false) {                                                                \
+  CONCATENATE(monitor, _ON):                                                  \
+    CONCATENATE(monitor, _ENABLED) = true;                                    \
+  }                                                                           \
+  const ::contract_light::contract_detail::SwitchSiteMonitor monitor(CONCATENATE(monitor, _ENABLED))
+#elif defined(CONTRACT_LIGHT_RUNTIME_LEVELS) || defined(CONTRACT_LIGHT_STATIC_KEYS)
+#define CONTRACT_LIGHT_SWITCH_MONITOR(monitor, site, classKey)                \
+  static ::contract_light::contract_detail::SiteSwitch CONCATENATE(monitor, _SWITCH); \
+  const ::contract_light::contract_detail::SwitchSiteMonitor monitor(site, CONCATENATE(monitor, _SWITCH), classKey, contract_light_module_tag::name())
+#else
+#define CONTRACT_LIGHT_SWITCH_MONITOR(monitor, site, classKey)                \
+  const ::contract_light::contract_detail::NoSiteMonitor monitor = {}
+#endif
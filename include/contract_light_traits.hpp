@@ -41,6 +41,43 @@ namespace contract_light
         static const bool value = result_type::value;
       };
 
+      /**
+       * Traits checks if the given type has a bool audit_invariant() const method
+       */
+      template <typename T>
+      class has_audit_invariant
+      {
+        template<typename U, bool(U::*)() const>
+        struct SFINAE {};
+
+        template<typename U>
+        static std::true_type try_method(SFINAE<U, &U::audit_invariant>*);
+
+        template<typename U>
+        static std::false_type try_method(...);
+
+        using result_type = decltype(try_method<T>(nullptr));
+      public:
+        static const bool value = result_type::value;
+      };
+
+      /**
+       * Traits checks if the given type has a contract_light_audit_schedule method
+       */
+      template <typename T>
+      class has_audit_schedule
+      {
+        template<typename U>
+        static auto try_method(U* p) -> decltype(p->contract_light_audit_schedule(), std::true_type());
+
+        template<typename U>
+        static std::false_type try_method(...);
+
+        using result_type = decltype(try_method<T>(nullptr));
+      public:
+        static const bool value = result_type::value;
+      };
+
       /**
       * Traits checks if the given type has a contract_light_contractor method
       */
@@ -9,8 +9,36 @@
 //////////////////////////////////////////////////////////////////
 
 #include "contract_light.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+
+#if defined(__GNUC__) && !defined(_WIN32)
+#define CONTRACT_LIGHT_HAS_UNWIND
+#include <unwind.h>
+// The return address of a failure handler, i.e. the first frame of the caller
+#define CONTRACT_LIGHT_CALLER __builtin_return_address(0)
+#else
+#define CONTRACT_LIGHT_CALLER nullptr
+#endif
+
+#ifdef CONTRACT_LIGHT_HAS_SITE_TABLE
+// Generated by the linker for the section contract_light_sites, if it exists
+extern "C" {
+  extern const contract_light::ContractSite* const __start_contract_light_sites[]
+    __attribute__((weak, visibility("hidden")));
+  extern const contract_light::ContractSite* const __stop_contract_light_sites[]
+    __attribute__((weak, visibility("hidden")));
+}
+#endif
 
 namespace {
   void defaultHandlerFailedPrecondition(const char* filename, int lineNumber) {
@@ -28,10 +56,483 @@ namespace {
     assert(0);
   }
 
-  contract_light::PreConditionFailedFunction preConditionFailed = &defaultHandlerFailedPrecondition;
-  contract_light::PostConditionFailedFunction postConditionFailed = &defaultHandlerFailedPostcondition;
-  contract_light::InvariantFailedFunction invariantFailed = &defaultHandlerFailedInvariant;
+  void defaultHandlerFailedDeferred(const contract_light::ContractSite& site, std::thread::id thread) {
+    std::cout << "Deferred check failed in " << site.fileName << ":" << site.line << " captured by thread " << thread;
+    assert(0);
+  }
+
+  // Handlers may be replaced while other threads report failures. Replacing
+  // is rare and the functions are immutable, so a relaxed load is enough.
+  std::atomic<contract_light::PreConditionFailedFunction> preConditionFailed(&defaultHandlerFailedPrecondition);
+  std::atomic<contract_light::PostConditionFailedFunction> postConditionFailed(&defaultHandlerFailedPostcondition);
+  std::atomic<contract_light::InvariantFailedFunction> invariantFailed(&defaultHandlerFailedInvariant);
+  std::atomic<contract_light::DeferredFailedFunction> deferredFailed(&defaultHandlerFailedDeferred);
+
+  // Adapters that call the handlers with the old signatures
+  void adaptPreCondition(const contract_light::ViolationInfo& info) {
+    preConditionFailed.load(std::memory_order_relaxed)(info.site->fileName, info.site->line);
+  }
+
+  void adaptPostCondition(const contract_light::ViolationInfo& info) {
+    postConditionFailed.load(std::memory_order_relaxed)(info.site->fileName, info.site->line);
+  }
+
+  void adaptInvariant(const contract_light::ViolationInfo& info) {
+    invariantFailed.load(std::memory_order_relaxed)(info.site->fileName, info.site->line);
+  }
+
+  void adaptDeferred(const contract_light::ViolationInfo& info) {
+    deferredFailed.load(std::memory_order_relaxed)(*info.site, info.thread);
+  }
+
+  // Indexed by ContractKind
+  std::atomic<contract_light::ViolationHandler> violationHandlers[] = {
+    { &adaptPreCondition }, { &adaptPostCondition }, { &adaptInvariant }, { &adaptDeferred }
+  };
+
+  std::atomic<contract_light::ViolationHandler>& violationHandler(contract_light::ContractKind kind) {
+    return violationHandlers[static_cast<int>(kind)];
+  }
+
+  const std::uint32_t maxViolationFrames = 32;
+  std::atomic<bool> stackCapture(true);
+
+  struct StackBuffer
+  {
+    const void* frames[maxViolationFrames];
+    std::uint32_t count;
+    const void* caller; // nullptr once the frames of the library are skipped
+  };
+
+#ifdef CONTRACT_LIGHT_HAS_UNWIND
+  _Unwind_Reason_Code collectFrame(_Unwind_Context* context, void* data) {
+    auto& buffer = *static_cast<StackBuffer*>(data);
+    const auto ip = _Unwind_GetIP(context);
+    if (ip == 0 || buffer.count == maxViolationFrames) {
+      return _URC_END_OF_STACK;
+    }
+    if (buffer.caller != nullptr && reinterpret_cast<const void*>(ip) == buffer.caller) {
+      buffer.count = 0;
+      buffer.caller = nullptr;
+    }
+    buffer.frames[buffer.count++] = reinterpret_cast<const void*>(ip);
+    return _URC_NO_REASON;
+  }
+#endif
+
+  /**
+   * Captures the return addresses of the current thread into its buffer, so
+   * nothing is allocated on the failure path. The frames of the library
+   * before the caller of the failure handler are dropped. If the caller is
+   * not found, all frames are kept. Symbolization is left to the decoder of
+   * the violation log.
+   */
+  const StackBuffer& captureStack(const void* caller) NOEXCEPT {
+    static THREAD_LOCAL StackBuffer buffer;
+    buffer.count = 0;
+    buffer.caller = caller;
+#ifdef CONTRACT_LIGHT_HAS_UNWIND
+    if (stackCapture.load(std::memory_order_relaxed)) {
+      _Unwind_Backtrace(&collectFrame, &buffer);
+    }
+#endif
+    return buffer;
+  }
+
+  contract_light::ViolationInfo violation(contract_light::ContractKind kind, const contract_light::ContractSite& site,
+                                          const void* object, std::thread::id thread, const void* caller) NOEXCEPT {
+    contract_light::ViolationInfo info = { kind, &site, object, thread, contract_light::contract_detail::readTicks(), nullptr, 0 };
+    // The stack of a deferred check is the one of the checker thread
+    if (thread == std::this_thread::get_id()) {
+      const auto& stack = captureStack(caller);
+      info.frames = stack.frames;
+      info.frameCount = stack.count;
+    }
+    return info;
+  }
+
+  struct Subscriber
+  {
+    contract_light::ViolationSubscriber function;
+    void* userData;
+    int id;
+  };
+
+  /**
+   * Immutable snapshot of the subscribers. An update publishes a new copy,
+   * so readers never block. A replaced snapshot is freed by the next update
+   * that finds no reader, since every reader that starts after the exchange
+   * gets the new snapshot.
+   */
+  struct SubscriberList
+  {
+    std::vector<Subscriber> subscribers;
+  };
+
+  std::atomic<const SubscriberList*> subscriberList(nullptr);
+  std::atomic<int> subscriberReaders(0);
+  std::mutex subscriberUpdateMutex;
+  std::vector<const SubscriberList*> retiredSubscriberLists;
+  int nextSubscriberId = 1;
+
+  void publishSubscribers(std::vector<Subscriber> subscribers) {
+    auto previous = subscriberList.exchange(new SubscriberList{ std::move(subscribers) });
+    if (previous != nullptr) {
+      retiredSubscriberLists.push_back(previous);
+    }
+    if (subscriberReaders.load() == 0) {
+      for (auto list : retiredSubscriberLists) {
+        delete list;
+      }
+      retiredSubscriberLists.clear();
+    }
+  }
+
+  void notifySubscribers(contract_light::ContractKind kind, const char* filename, int lineNumber) NOEXCEPT {
+    ++subscriberReaders;
+    if (auto list = subscriberList.load()) {
+      for (const auto& s : list->subscribers) {
+        s.function(kind, filename, lineNumber, s.userData);
+      }
+    }
+    --subscriberReaders;
+  }
+
+  const char* kindName(contract_light::ContractKind kind) {
+    switch (kind) {
+    case contract_light::ContractKind::PreCondition: return "PreCondition";
+    case contract_light::ContractKind::PostCondition: return "PostCondition";
+    case contract_light::ContractKind::Invariant: return "Invariant";
+    case contract_light::ContractKind::Deferred: return "Deferred check";
+    }
+    return "Contract";
+  }
+
+  void defaultViolationSummary(const contract_light::ViolationSummary& s) {
+    std::cout << kindName(s.kind) << " in " << s.site->fileName << ":" << s.site->line << " failed "
+              << s.suppressed << " more times in the last "
+              << std::chrono::duration_cast<std::chrono::seconds>(s.interval).count() << " s\n";
+  }
+
+  std::atomic<std::uint32_t> reportLimit(0);
+  std::atomic<std::int64_t> summaryInterval(std::chrono::nanoseconds(std::chrono::seconds(10)).count());
+  std::atomic<contract_light::ViolationSummaryHandler> summaryHandler(&defaultViolationSummary);
+
+  /**
+   * The failures of one site and kind. A slot is claimed by the first
+   * failure that stores its key and is never released, so the reporting
+   * threads do not need a lock.
+   */
+  struct ReportSlot
+  {
+    std::atomic<std::uintptr_t> key;
+    std::atomic<std::uint64_t> failures;
+    std::atomic<std::uint64_t> suppressed;
+    std::atomic<std::int64_t> summaryTime; // 0 until the first suppressed failure
+  };
+
+  const std::size_t reportSlotCount = 1024;
+  const std::size_t reportSlotProbes = 16;
+  ReportSlot reportSlots[reportSlotCount];
+
+  static_assert(alignof(contract_light::ContractSite) >= 4, "The contract kind is kept in the low bits of the site address");
+
+  std::uintptr_t reportKey(contract_light::ContractKind kind, const contract_light::ContractSite& site) {
+    return reinterpret_cast<std::uintptr_t>(&site) | static_cast<std::uintptr_t>(kind);
+  }
+
+  /**
+   * Returns the slot of the key or nullptr, if its probes are all taken by
+   * other sites. Then the failures are not limited.
+   */
+  ReportSlot* reportSlot(std::uintptr_t key) {
+    const auto hash = static_cast<std::size_t>((static_cast<std::uint64_t>(key) * 0x9e3779b97f4a7c15ull) >> 32);
+    for (std::size_t i = 0; i < reportSlotProbes; ++i) {
+      auto& slot = reportSlots[(hash + i) & (reportSlotCount - 1)];
+      std::uintptr_t current = 0;
+      if (slot.key.compare_exchange_strong(current, key, std::memory_order_relaxed) || current == key) {
+        return &slot;
+      }
+    }
+    return nullptr;
+  }
+
+  std::int64_t steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void reportSummary(const ReportSlot& slot, std::uint64_t suppressed, std::int64_t interval) NOEXCEPT {
+    const auto key = slot.key.load(std::memory_order_relaxed);
+    const contract_light::ViolationSummary summary = {
+      static_cast<contract_light::ContractKind>(key & 3),
+      reinterpret_cast<const contract_light::ContractSite*>(key & ~std::uintptr_t(3)),
+      suppressed, std::chrono::nanoseconds(interval) };
+    summaryHandler.load(std::memory_order_relaxed)(summary);
+  }
+
+  /**
+   * Reports the summary of the slot, if its interval is over. Only the
+   * thread that moves the summary time on reports it.
+   */
+  void reportSummaryIfDue(ReportSlot& slot, std::int64_t now) NOEXCEPT {
+    auto last = slot.summaryTime.load(std::memory_order_relaxed);
+    if (last != 0 && now - last >= summaryInterval.load(std::memory_order_relaxed) &&
+        slot.summaryTime.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+      const auto suppressed = slot.suppressed.exchange(0, std::memory_order_relaxed);
+      if (suppressed > 0) {
+        reportSummary(slot, suppressed, now - last);
+      }
+    }
+  }
 
+  /**
+   * Counts the failure and decides if it goes to the handler. A suppressed
+   * failure reports the summary of its slot, if the interval is over.
+   */
+  bool passToHandler(contract_light::ContractKind kind, const contract_light::ContractSite& site) NOEXCEPT {
+    const auto limit = reportLimit.load(std::memory_order_relaxed);
+    if (limit == 0) {
+      return true;
+    }
+    auto slot = reportSlot(reportKey(kind, site));
+    if (slot == nullptr || slot->failures.fetch_add(1, std::memory_order_relaxed) < limit) {
+      return true;
+    }
+    slot->suppressed.fetch_add(1, std::memory_order_relaxed);
+    const auto now = steadyNanoseconds();
+    std::int64_t unset = 0;
+    if (slot->summaryTime.load(std::memory_order_relaxed) == 0 &&
+        slot->summaryTime.compare_exchange_strong(unset, now, std::memory_order_relaxed)) {
+      return false;
+    }
+    reportSummaryIfDue(*slot, now);
+    return false;
+  }
+
+  /**
+   * Reports the due summaries while a report limit is set, so that the
+   * summary of a site does not wait for its next failure
+   */
+  struct SummaryReporter
+  {
+    std::mutex controlMutex; // serializes start and stop
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::thread thread;
+    bool stopRequested = false;
+
+    // Never destroyed, like the governor. A running thread is not joined at exit.
+    static SummaryReporter& instance() {
+      static SummaryReporter& reporter = *new SummaryReporter;
+      return reporter;
+    }
+
+    void start() {
+      std::lock_guard<std::mutex> control(controlMutex);
+      if (thread.joinable()) {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopRequested = false;
+      }
+      thread = std::thread([this] { run(); });
+    }
+
+    void stop() {
+      std::lock_guard<std::mutex> control(controlMutex);
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopRequested = true;
+      }
+      wakeUp.notify_all();
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+
+    void run() {
+      // With a short interval the failures report their summaries themselves
+      const std::int64_t minimumPeriod = std::chrono::nanoseconds(std::chrono::milliseconds(100)).count();
+      std::unique_lock<std::mutex> lock(mutex);
+      for (;;) {
+        const auto period = std::max(summaryInterval.load(std::memory_order_relaxed), minimumPeriod);
+        if (wakeUp.wait_for(lock, std::chrono::nanoseconds(period), [this] { return stopRequested; })) {
+          return;
+        }
+        lock.unlock();
+        for (auto& slot : reportSlots) {
+          if (slot.key.load(std::memory_order_relaxed) != 0 && slot.suppressed.load(std::memory_order_relaxed) > 0) {
+            reportSummaryIfDue(slot, steadyNanoseconds());
+          }
+        }
+        lock.lock();
+      }
+    }
+  };
+
+  using contract_light::ContractSite;
+  using contract_light::contract_detail::SiteCounters;
+  using contract_light::contract_detail::SiteProfile;
+
+  struct CounterTotals
+  {
+    std::uint64_t evaluations;
+    std::uint64_t failures;
+    std::uint64_t invariantChecks;
+
+    void add(const SiteCounters& c) {
+      evaluations += c.evaluations.load(std::memory_order_relaxed);
+      failures += c.failures.load(std::memory_order_relaxed);
+      invariantChecks += c.invariantChecks.load(std::memory_order_relaxed);
+    }
+  };
+
+  struct ProfileTotals
+  {
+    std::uint64_t totalTicks;
+    std::uint64_t histogram[SiteProfile::buckets];
+
+    void add(const SiteProfile& p) {
+      totalTicks += p.totalTicks.load(std::memory_order_relaxed);
+      for (int i = 0; i < SiteProfile::buckets; ++i) {
+        histogram[i] += p.histogram[i].load(std::memory_order_relaxed);
+      }
+    }
+  };
+
+  /**
+   * All per thread shards of one kind of the running threads and the totals
+   * of the shards of the finished threads. Only registration, thread exit
+   * and merging take the lock, never the recording itself.
+   */
+  template <typename Shard, typename Totals>
+  struct ShardRegistry
+  {
+    std::mutex mutex;
+    std::vector<const Shard*> shards;
+    std::map<const ContractSite*, Totals> retired;
+
+    // Never destroyed, so that threads that exit during the shutdown and
+    // the governor thread can still use it
+    static ShardRegistry& instance() {
+      static ShardRegistry& registry = *new ShardRegistry;
+      return registry;
+    }
+
+    std::map<const ContractSite*, Totals> merge() {
+      std::lock_guard<std::mutex> guard(mutex);
+      auto totals = retired;
+      for (auto s : shards) {
+        totals[s->site].add(*s);
+      }
+      return totals;
+    }
+  };
+
+  /**
+   * The shards of the current thread. Its destruction on thread exit folds
+   * them into the retired totals, before their thread local storage is gone.
+   */
+  template <typename Shard, typename Totals>
+  struct ThreadShards
+  {
+    Shard* head = nullptr;
+
+    ~ThreadShards() {
+      auto& registry = ShardRegistry<Shard, Totals>::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      for (auto s = head; s != nullptr; s = s->next) {
+        registry.retired[s->site].add(*s);
+        registry.shards.erase(std::find(registry.shards.begin(), registry.shards.end(), s));
+      }
+    }
+  };
+
+  template <typename Shard, typename Totals>
+  void registerShard(const ContractSite& site, Shard& shard) {
+    auto& registry = ShardRegistry<Shard, Totals>::instance();
+    static THREAD_LOCAL ThreadShards<Shard, Totals> threadShards;
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    registry.shards.push_back(&shard);
+    shard.site = &site;
+    shard.next = threadShards.head;
+    threadShards.head = &shard;
+  }
+
+  template <typename Record>
+  void sortBySite(std::vector<Record>& records) {
+    std::sort(records.begin(), records.end(), [](const Record& l, const Record& r) {
+      const auto cmp = std::strcmp(l.site->fileName, r.site->fileName);
+      return cmp != 0 ? cmp < 0 : l.site->line < r.site->line;
+    });
+  }
+
+  /**
+   * Returns the upper bound of the bucket that contains the percentile
+   */
+  std::uint64_t percentile(const ProfileTotals& p, std::uint64_t evaluations, double fraction) {
+    const auto rank = static_cast<std::uint64_t>(fraction * evaluations + 0.5);
+    std::uint64_t count = 0;
+    for (int i = 0; i < SiteProfile::buckets; ++i) {
+      count += p.histogram[i];
+      if (count >= rank && count > 0) {
+        return i == 0 ? 0 : i < 64 ? (std::uint64_t(1) << i) - 1 : ~std::uint64_t(0);
+      }
+    }
+    return 0;
+  }
+
+  using contract_light::SamplingMode;
+  using contract_light::contract_detail::SiteSampling;
+
+  /**
+   * The sample rates. The rate of each registered site is updated whenever
+   * the configuration changes, so the sampling itself only reads it.
+   */
+  struct SamplingRegistry
+  {
+    std::mutex mutex;
+    std::uint32_t globalRate = 1;
+    std::map<std::uint64_t, std::uint32_t> siteRates;
+    std::map<std::uint64_t, std::uint32_t> throttles;
+    std::multimap<std::uint64_t, SiteSampling*> sites;
+
+    static SamplingRegistry& instance() {
+      static SamplingRegistry& registry = *new SamplingRegistry;
+      return registry;
+    }
+
+    /**
+     * The configured rate of the site, with the period multiplied by the
+     * throttle of the governor
+     */
+    std::uint32_t rateOf(std::uint64_t siteId) const {
+      auto it = siteRates.find(siteId);
+      const auto rate = it != siteRates.end() ? it->second : globalRate;
+      auto throttle = throttles.find(siteId);
+      if (throttle == throttles.end()) {
+        return rate;
+      }
+      const auto period = std::min<std::uint64_t>(
+        static_cast<std::uint64_t>(rate & SiteSampling::maxPeriod) * throttle->second, SiteSampling::maxPeriod);
+      return (rate & SiteSampling::randomMode) | static_cast<std::uint32_t>(period);
+    }
+
+    void updateSite(std::uint64_t siteId) {
+      const auto rate = rateOf(siteId);
+      auto range = sites.equal_range(siteId);
+      for (auto it = range.first; it != range.second; ++it) {
+        it->second->rate.store(rate, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  std::uint32_t encodeRate(std::uint32_t period, SamplingMode mode) {
+    period = std::max<std::uint32_t>(1, std::min(period, SiteSampling::maxPeriod));
+    return mode == SamplingMode::Random ? period | SiteSampling::randomMode : period;
+  }
 }
 
 
@@ -40,35 +541,270 @@ namespace contract_light {
   inline
 #endif
   namespace v_100 {
+    ViolationHandler setViolationHandler(ContractKind kind, ViolationHandler h) NOEXCEPT {
+      if (h == nullptr) {
+        return violationHandler(kind).load(std::memory_order_relaxed);
+      }
+      return violationHandler(kind).exchange(h, std::memory_order_relaxed);
+    }
+
     void setHandlerFailedPreCondition(PreConditionFailedFunction h) NOEXCEPT {
       if (h != nullptr) {
-        preConditionFailed = h;
+        preConditionFailed.store(h, std::memory_order_relaxed);
+        setViolationHandler(ContractKind::PreCondition, &adaptPreCondition);
       }
     }
 
     void setHandlerFailedPostCondition(PostConditionFailedFunction h) NOEXCEPT {
       if (h != nullptr) {
-        postConditionFailed = h;
+        postConditionFailed.store(h, std::memory_order_relaxed);
+        setViolationHandler(ContractKind::PostCondition, &adaptPostCondition);
       }
     }
 
     void setHandlerFailedInvariant(InvariantFailedFunction h) NOEXCEPT {
       if (h != nullptr) {
-        invariantFailed = h;
+        invariantFailed.store(h, std::memory_order_relaxed);
+        setViolationHandler(ContractKind::Invariant, &adaptInvariant);
       }
     }
 
+    void setHandlerFailedDeferred(DeferredFailedFunction h) NOEXCEPT {
+      if (h != nullptr) {
+        deferredFailed.store(h, std::memory_order_relaxed);
+        setViolationHandler(ContractKind::Deferred, &adaptDeferred);
+      }
+    }
+
+    void setViolationStackCapture(bool enabled) NOEXCEPT {
+      stackCapture.store(enabled, std::memory_order_relaxed);
+    }
+
+    int addViolationSubscriber(ViolationSubscriber f, void* userData) {
+      if (f == nullptr) {
+        return 0;
+      }
+      std::lock_guard<std::mutex> guard(subscriberUpdateMutex);
+      auto list = subscriberList.load(std::memory_order_relaxed);
+      auto subscribers = list != nullptr ? list->subscribers : std::vector<Subscriber>();
+      const Subscriber s = { f, userData, nextSubscriberId++ };
+      subscribers.push_back(s);
+      publishSubscribers(std::move(subscribers));
+      return s.id;
+    }
+
+    bool removeViolationSubscriber(int id) {
+      std::lock_guard<std::mutex> guard(subscriberUpdateMutex);
+      auto list = subscriberList.load(std::memory_order_relaxed);
+      if (list == nullptr) {
+        return false;
+      }
+      auto subscribers = list->subscribers;
+      auto it = std::find_if(subscribers.begin(), subscribers.end(), [id](const Subscriber& s) { return s.id == id; });
+      if (it == subscribers.end()) {
+        return false;
+      }
+      subscribers.erase(it);
+      publishSubscribers(std::move(subscribers));
+      return true;
+    }
+
+    void setViolationReportLimit(std::uint32_t limit, std::chrono::seconds interval) NOEXCEPT {
+      summaryInterval.store(std::chrono::nanoseconds(interval).count(), std::memory_order_relaxed);
+      reportLimit.store(limit, std::memory_order_relaxed);
+      try {
+        if (limit > 0) {
+          SummaryReporter::instance().start();
+        }
+        else {
+          SummaryReporter::instance().stop();
+        }
+      }
+      catch (...) {
+        // Without the thread the summaries are reported by the next failures
+      }
+    }
+
+    void setViolationSummaryHandler(ViolationSummaryHandler h) NOEXCEPT {
+      if (h != nullptr) {
+        summaryHandler.store(h, std::memory_order_relaxed);
+      }
+    }
+
+    void flushViolationSummaries() NOEXCEPT {
+      for (auto& slot : reportSlots) {
+        if (slot.key.load(std::memory_order_relaxed) == 0) {
+          continue;
+        }
+        const auto suppressed = slot.suppressed.exchange(0, std::memory_order_relaxed);
+        if (suppressed > 0) {
+          const auto now = steadyNanoseconds();
+          reportSummary(slot, suppressed, now - slot.summaryTime.exchange(now, std::memory_order_relaxed));
+        }
+      }
+    }
+
+    void resetViolationReports() NOEXCEPT {
+      for (auto& slot : reportSlots) {
+        slot.failures.store(0, std::memory_order_relaxed);
+        slot.suppressed.store(0, std::memory_order_relaxed);
+        slot.summaryTime.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    std::vector<const ContractSite*> contractSites() {
+      std::vector<const ContractSite*> result;
+#ifdef CONTRACT_LIGHT_HAS_SITE_TABLE
+      if (__start_contract_light_sites == nullptr) {
+        return result;
+      }
+      // A site of an inline function is one object, but every translation
+      // unit and every inlined copy of the function lists its address
+      result.assign(__start_contract_light_sites, __stop_contract_light_sites);
+      std::sort(result.begin(), result.end());
+      result.erase(std::unique(result.begin(), result.end()), result.end());
+      result.erase(std::remove(result.begin(), result.end(), nullptr), result.end());
+      std::sort(result.begin(), result.end(), [](const ContractSite* l, const ContractSite* r) {
+        const auto cmp = std::strcmp(l->fileName, r->fileName);
+        return cmp != 0 ? cmp < 0 : l->line < r->line;
+      });
+#endif
+      return result;
+    }
+
+    void setSampleRate(std::uint32_t period, SamplingMode mode) {
+      auto& registry = SamplingRegistry::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      registry.globalRate = encodeRate(period, mode);
+      for (const auto& s : registry.sites) {
+        s.second->rate.store(registry.rateOf(s.first), std::memory_order_relaxed);
+      }
+    }
+
+    void setSiteSampleRate(std::uint64_t siteId, std::uint32_t period, SamplingMode mode) {
+      auto& registry = SamplingRegistry::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      registry.siteRates[siteId] = encodeRate(period, mode);
+      registry.updateSite(siteId);
+    }
+
+    void resetSiteSampleRate(std::uint64_t siteId) {
+      auto& registry = SamplingRegistry::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      registry.siteRates.erase(siteId);
+      registry.updateSite(siteId);
+    }
+
+    std::vector<SiteSnapshot> snapshot() {
+      const auto totals = ShardRegistry<SiteCounters, CounterTotals>::instance().merge();
+      std::vector<SiteSnapshot> result;
+      result.reserve(totals.size());
+      for (const auto& t : totals) {
+        const SiteSnapshot s = { t.first, t.second.evaluations, t.second.failures, t.second.invariantChecks };
+        result.push_back(s);
+      }
+      sortBySite(result);
+      return result;
+    }
+
+    std::vector<SiteCost> mostExpensiveSites(std::size_t n, CostOrder order) {
+      const auto totals = ShardRegistry<SiteProfile, ProfileTotals>::instance().merge();
+      std::vector<SiteCost> result;
+      result.reserve(totals.size());
+      for (const auto& t : totals) {
+        std::uint64_t evaluations = 0;
+        for (auto b : t.second.histogram) {
+          evaluations += b;
+        }
+        const SiteCost c = { t.first, evaluations, t.second.totalTicks, percentile(t.second, evaluations, 0.99) };
+        result.push_back(c);
+      }
+      sortBySite(result);
+      std::stable_sort(result.begin(), result.end(), [order](const SiteCost& l, const SiteCost& r) {
+        return order == CostOrder::Total ? l.totalTicks > r.totalTicks : l.p99Ticks > r.p99Ticks;
+      });
+      if (result.size() > n) {
+        result.resize(n);
+      }
+      return result;
+    }
+
     namespace contract_detail {
-      void handleFailedPreCondition(const char* filename, int lineNumber) {
-        preConditionFailed(filename, lineNumber);
+      const std::uint32_t SiteSampling::randomMode;
+      const std::uint32_t SiteSampling::maxPeriod;
+
+      void registerSiteCounters(const ContractSite& site, SiteCounters& counters) {
+        registerShard<SiteCounters, CounterTotals>(site, counters);
+      }
+
+      void registerSiteProfile(const ContractSite& site, SiteProfile& profile) {
+        registerShard<SiteProfile, ProfileTotals>(site, profile);
+      }
+
+      std::uint32_t registerSiteSampling(const ContractSite& site, SiteSampling& sampling) {
+        auto& registry = SamplingRegistry::instance();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        if (sampling.rate.load(std::memory_order_relaxed) == 0) {
+          registry.sites.insert(std::make_pair(site.id, &sampling));
+          sampling.rate.store(registry.rateOf(site.id), std::memory_order_relaxed);
+        }
+        return sampling.rate.load(std::memory_order_relaxed);
+      }
+
+      void setSiteThrottle(std::uint64_t siteId, std::uint32_t factor) {
+        auto& registry = SamplingRegistry::instance();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        if (factor > 1) {
+          registry.throttles[siteId] = factor;
+        }
+        else {
+          registry.throttles.erase(siteId);
+        }
+        registry.updateSite(siteId);
+      }
+
+      std::uint32_t samplingSeed() NOEXCEPT {
+        const auto seed = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+          static_cast<std::size_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        const auto x = static_cast<std::uint32_t>(seed ^ (static_cast<std::uint64_t>(seed) >> 32));
+        return x != 0 ? x : 0x9e3779b9u;
+      }
+
+      std::size_t retiredSubscriberSnapshots() {
+        std::lock_guard<std::mutex> guard(subscriberUpdateMutex);
+        return retiredSubscriberLists.size();
+      }
+
+      void handleFailedPreCondition(const ContractSite& site, const void* object) {
+        notifySubscribers(ContractKind::PreCondition, site.fileName, site.line);
+        if (passToHandler(ContractKind::PreCondition, site)) {
+          violationHandler(ContractKind::PreCondition).load(std::memory_order_relaxed)(
+            violation(ContractKind::PreCondition, site, object, std::this_thread::get_id(), CONTRACT_LIGHT_CALLER));
+        }
+      }
+
+      void handleFailedPostCondition(const ContractSite& site, const void* object) NOEXCEPT {
+        notifySubscribers(ContractKind::PostCondition, site.fileName, site.line);
+        if (passToHandler(ContractKind::PostCondition, site)) {
+          violationHandler(ContractKind::PostCondition).load(std::memory_order_relaxed)(
+            violation(ContractKind::PostCondition, site, object, std::this_thread::get_id(), CONTRACT_LIGHT_CALLER));
+        }
       }
 
-      void handleFailedPostCondition(const char* filename, int lineNumber) NOEXCEPT {
-        postConditionFailed(filename, lineNumber);
+      void handleFailedInvariant(const ContractSite& site, const void* object) NOEXCEPT {
+        notifySubscribers(ContractKind::Invariant, site.fileName, site.line);
+        if (passToHandler(ContractKind::Invariant, site)) {
+          violationHandler(ContractKind::Invariant).load(std::memory_order_relaxed)(
+            violation(ContractKind::Invariant, site, object, std::this_thread::get_id(), CONTRACT_LIGHT_CALLER));
+        }
       }
 
-      void handleFailedInvariant(const char* filename, int lineNumber)  NOEXCEPT {
-        invariantFailed(filename, lineNumber);
+      void handleFailedDeferred(const ContractSite& site, std::thread::id thread) NOEXCEPT {
+        notifySubscribers(ContractKind::Deferred, site.fileName, site.line);
+        if (passToHandler(ContractKind::Deferred, site)) {
+          violationHandler(ContractKind::Deferred).load(std::memory_order_relaxed)(
+            violation(ContractKind::Deferred, site, nullptr, thread, CONTRACT_LIGHT_CALLER));
+        }
       }
     }
 
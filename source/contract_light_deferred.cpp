@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include "contract_light.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+  using contract_light::contract_detail::DeferredCheck;
+  using contract_light::contract_detail::DeferredQueue;
+
+  /**
+   * The consumer side of the queue. Only one thread at a time drains it.
+   */
+  struct DeferredChecker
+  {
+    std::mutex drainMutex;
+    std::atomic<std::uint64_t> checked;
+    std::atomic<std::uint64_t> failed;
+
+    std::mutex threadMutex;
+    std::condition_variable wakeUp;
+    std::thread thread;
+    bool stopRequested;
+    bool running;
+
+    DeferredChecker() : checked(0), failed(0), stopRequested(false), running(false) {}
+
+    static DeferredChecker& instance() {
+      // Never destroyed, because other threads may still check on exit
+      static DeferredChecker& checker = *new DeferredChecker;
+      return checker;
+    }
+
+    std::size_t drain() {
+      std::lock_guard<std::mutex> guard(drainMutex);
+      auto& queue = contract_light::contract_detail::deferredQueue();
+      std::size_t count = 0;
+      for (;;) {
+        const auto position = queue.dequeuePosition.load(std::memory_order_relaxed);
+        auto& cell = queue.cells[position & (DeferredQueue::size - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+          break;
+        }
+        queue.dequeuePosition.store(position + 1, std::memory_order_relaxed);
+        bool fulfilled;
+        try {
+          fulfilled = cell.evaluate(&cell.predicate);
+        }
+        catch (...) {
+          // A check that throws counts as failed, so the checker thread goes on
+          fulfilled = false;
+        }
+        if (CONTRACT_LIGHT_UNLIKELY(!fulfilled)) {
+          failed.fetch_add(1, std::memory_order_relaxed);
+          contract_light::contract_detail::handleFailedDeferred(*cell.site, cell.thread);
+        }
+        cell.sequence.store(position + DeferredQueue::size, std::memory_order_release);
+        ++count;
+      }
+      checked.fetch_add(count, std::memory_order_relaxed);
+      return count;
+    }
+
+    void stop() {
+      {
+        std::lock_guard<std::mutex> guard(threadMutex);
+        stopRequested = true;
+        running = false;
+      }
+      wakeUp.notify_all();
+      if (thread.joinable()) {
+        thread.join();
+      }
+      drain();
+    }
+
+    void run(std::chrono::milliseconds interval) {
+      std::unique_lock<std::mutex> lock(threadMutex);
+      while (!stopRequested) {
+        lock.unlock();
+        const auto count = drain();
+        lock.lock();
+        if (count == 0) {
+          wakeUp.wait_for(lock, interval, [this] { return stopRequested; });
+        }
+      }
+    }
+  };
+}
+
+
+namespace contract_light {
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100 {
+    void startDeferredChecker(std::chrono::milliseconds interval) {
+      auto& checker = DeferredChecker::instance();
+      stopDeferredChecker();
+      std::lock_guard<std::mutex> guard(checker.threadMutex);
+      checker.stopRequested = false;
+      checker.running = true;
+      checker.thread = std::thread([&checker, interval] { checker.run(interval); });
+    }
+
+    void stopDeferredChecker() {
+      DeferredChecker::instance().stop();
+    }
+
+    std::size_t checkDeferredContracts() {
+      return DeferredChecker::instance().drain();
+    }
+
+    DeferredStatus deferredStatus() {
+      auto& checker = DeferredChecker::instance();
+      DeferredStatus status;
+      {
+        std::lock_guard<std::mutex> guard(checker.threadMutex);
+        status.running = checker.running;
+      }
+      status.checked = checker.checked.load(std::memory_order_relaxed);
+      status.failed = checker.failed.load(std::memory_order_relaxed);
+      status.dropped = contract_detail::deferredQueue().dropped.load(std::memory_order_relaxed);
+      return status;
+    }
+
+    namespace contract_detail {
+      DeferredQueue& deferredQueue() NOEXCEPT {
+        // Trivially destructible, so it stays valid during the static destruction
+        static DeferredQueue queue;
+        return queue;
+      }
+    }
+  }
+}
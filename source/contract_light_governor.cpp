@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include "contract_light.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <ctime>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+  using contract_light::ContractSite;
+
+  struct SiteState
+  {
+    const ContractSite* site;
+    std::uint64_t lastTicks;
+    std::uint32_t throttle;
+    double cpuShare;
+  };
+
+  struct SiteDelta
+  {
+    std::uint64_t id;
+    std::uint64_t ticks;
+  };
+
+  /**
+   * The throttle decisions per site id. All instances of a site, e.g. in
+   * different template instantiations, share one decision.
+   */
+  struct Governor
+  {
+    std::mutex mutex;
+    std::map<std::uint64_t, SiteState> sites;
+    double cpuShare = 0.0;
+
+    std::mutex threadMutex;
+    std::condition_variable wakeUp;
+    std::thread thread;
+    bool stopRequested = false;
+    bool running = false;
+
+    // Never destroyed, so that guards in static destructors and on detached
+    // threads can still use it. A running thread is not joined at exit.
+    static Governor& instance() {
+      static Governor& governor = *new Governor;
+      return governor;
+    }
+
+    void stop() {
+      {
+        std::lock_guard<std::mutex> guard(threadMutex);
+        stopRequested = true;
+        running = false;
+      }
+      wakeUp.notify_all();
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+
+    void run(contract_light::GovernorConfig config) {
+      auto lastWall = std::chrono::steady_clock::now();
+      auto lastTicks = contract_light::contract_detail::readTicks();
+      auto lastCpu = std::clock();
+
+      std::unique_lock<std::mutex> lock(threadMutex);
+      while (!wakeUp.wait_for(lock, config.interval, [this] { return stopRequested; })) {
+        lock.unlock();
+        const auto wall = std::chrono::steady_clock::now();
+        const auto ticks = contract_light::contract_detail::readTicks();
+        const auto cpu = std::clock();
+
+        // The ticks are calibrated against the wall clock in each step
+        const auto wallSeconds = std::chrono::duration<double>(wall - lastWall).count();
+        const auto cpuSeconds = static_cast<double>(cpu - lastCpu) / CLOCKS_PER_SEC;
+        if (wallSeconds > 0.0 && cpuSeconds >= 0.0) {
+          const auto ticksPerSecond = static_cast<double>(ticks - lastTicks) / wallSeconds;
+          contract_light::governContracts(static_cast<std::uint64_t>(cpuSeconds * ticksPerSecond), config);
+        }
+        lastWall = wall;
+        lastTicks = ticks;
+        lastCpu = cpu;
+        lock.lock();
+      }
+    }
+  };
+}
+
+
+namespace contract_light {
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100 {
+    void startGovernor(const GovernorConfig& config) {
+      auto& governor = Governor::instance();
+      stopGovernor();
+      std::lock_guard<std::mutex> guard(governor.threadMutex);
+      governor.stopRequested = false;
+      governor.running = true;
+      governor.thread = std::thread([&governor, config] { governor.run(config); });
+    }
+
+    void stopGovernor() {
+      Governor::instance().stop();
+    }
+
+    void governContracts(std::uint64_t cpuTicks, const GovernorConfig& config) {
+      // Cost per site id since the last step
+      std::map<std::uint64_t, std::pair<const ContractSite*, std::uint64_t>> totals;
+      for (const auto& c : mostExpensiveSites(std::numeric_limits<std::size_t>::max())) {
+        auto& t = totals[c.site->id];
+        t.first = c.site;
+        t.second += c.totalTicks;
+      }
+
+      auto& governor = Governor::instance();
+      std::lock_guard<std::mutex> guard(governor.mutex);
+      std::vector<SiteDelta> deltas;
+      std::uint64_t spent = 0;
+      for (const auto& t : totals) {
+        auto it = governor.sites.find(t.first);
+        if (it == governor.sites.end()) {
+          const SiteState s = { t.second.first, 0, 1, 0.0 };
+          it = governor.sites.insert(std::make_pair(t.first, s)).first;
+        }
+        auto& site = it->second;
+        const auto ticks = t.second.second >= site.lastTicks ? t.second.second - site.lastTicks : 0;
+        site.lastTicks = t.second.second;
+        site.cpuShare = cpuTicks > 0 ? static_cast<double>(ticks) / cpuTicks : 0.0;
+        spent += ticks;
+        const SiteDelta d = { t.first, ticks };
+        deltas.push_back(d);
+      }
+      governor.cpuShare = cpuTicks > 0 ? static_cast<double>(spent) / cpuTicks : 0.0;
+
+      const auto budget = config.cpuShare * cpuTicks;
+      auto projected = static_cast<double>(spent);
+      if (projected > budget) {
+        // Doubling the period of a site halves its cost
+        std::sort(deltas.begin(), deltas.end(), [](const SiteDelta& l, const SiteDelta& r) { return l.ticks > r.ticks; });
+        for (const auto& d : deltas) {
+          if (projected <= budget) {
+            break;
+          }
+          auto& site = governor.sites[d.id];
+          if (d.ticks == 0 || site.throttle >= config.maxThrottle) {
+            continue;
+          }
+          site.throttle = std::min(site.throttle * 2, config.maxThrottle);
+          projected -= d.ticks / 2.0;
+          contract_detail::setSiteThrottle(d.id, site.throttle);
+        }
+      }
+      else if (projected < budget / 2) {
+        // Relax the cheapest sites first, as long as there is headroom
+        std::sort(deltas.begin(), deltas.end(), [](const SiteDelta& l, const SiteDelta& r) { return l.ticks < r.ticks; });
+        for (const auto& d : deltas) {
+          auto& site = governor.sites[d.id];
+          if (site.throttle <= 1) {
+            continue;
+          }
+          if (projected + d.ticks > budget / 2) {
+            break;
+          }
+          site.throttle /= 2;
+          projected += d.ticks;
+          contract_detail::setSiteThrottle(d.id, site.throttle);
+        }
+      }
+    }
+
+    void resetGovernor() {
+      auto& governor = Governor::instance();
+      std::lock_guard<std::mutex> guard(governor.mutex);
+      for (auto& s : governor.sites) {
+        if (s.second.throttle > 1) {
+          contract_detail::setSiteThrottle(s.first, 1);
+          s.second.throttle = 1;
+        }
+      }
+    }
+
+    GovernorStatus governorStatus() {
+      auto& governor = Governor::instance();
+      GovernorStatus status;
+      {
+        std::lock_guard<std::mutex> guard(governor.threadMutex);
+        status.running = governor.running;
+      }
+      std::lock_guard<std::mutex> guard(governor.mutex);
+      status.cpuShare = governor.cpuShare;
+      for (const auto& s : governor.sites) {
+        if (s.second.throttle > 1) {
+          const ThrottledSite t = { s.second.site, s.second.throttle, s.second.cpuShare };
+          status.throttled.push_back(t);
+        }
+      }
+      std::stable_sort(status.throttled.begin(), status.throttled.end(), [](const ThrottledSite& l, const ThrottledSite& r) {
+        return l.throttle > r.throttle;
+      });
+      return status;
+    }
+  }
+}
@@ -0,0 +1,429 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include "contract_light.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+  using contract_light::contract_detail::LogBlock;
+  using contract_light::contract_detail::LogBlockTag;
+  using contract_light::contract_detail::LogRecord;
+  using contract_light::contract_detail::LogSession;
+  using contract_light::contract_detail::LogSite;
+  using contract_light::contract_detail::LogSync;
+
+  /**
+   * The records of one thread, written by it and read by the flusher. A
+   * ring is handed over to a new thread when its thread exits, so rings
+   * are never freed.
+   */
+  struct alignas(64) LogRing
+  {
+    static const std::size_t size = 256;
+
+    LogRing() : head(0), tail(0), owned(true), next(nullptr) {}
+
+    alignas(64) std::atomic<std::size_t> head;
+    alignas(64) std::atomic<std::size_t> tail;
+    std::atomic<bool> owned;
+    LogRing* next;
+    LogRecord records[size];
+  };
+
+  std::atomic<LogRing*> rings(nullptr);
+  std::atomic<std::uint64_t> droppedRecords(0);
+
+  LogRing* acquireRing() {
+    for (auto r = rings.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+      bool expected = false;
+      if (!r->owned.load(std::memory_order_relaxed) &&
+          r->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        return r;
+      }
+    }
+    // C++11 new does not respect the extended alignment
+    auto ring = new (::aligned_alloc(alignof(LogRing), sizeof(LogRing))) LogRing;
+    ring->next = rings.load(std::memory_order_relaxed);
+    while (!rings.compare_exchange_weak(ring->next, ring, std::memory_order_release, std::memory_order_relaxed)) {}
+    return ring;
+  }
+
+  struct RingOwner
+  {
+    LogRing* ring = nullptr;
+
+    ~RingOwner() {
+      if (ring != nullptr) {
+        ring->owned.store(false, std::memory_order_release);
+      }
+    }
+  };
+
+  LogRing& threadRing() {
+    static THREAD_LOCAL RingOwner owner;
+    if (CONTRACT_LIGHT_UNLIKELY(owner.ring == nullptr)) {
+      owner.ring = acquireRing();
+    }
+    return *owner.ring;
+  }
+
+  /**
+   * The lines of /proc/self/maps of the executable mappings, that the
+   * decoder needs to find the files of the frames
+   */
+  std::string executableMappings() {
+    std::string result;
+#ifdef __linux__
+    auto maps = std::fopen("/proc/self/maps", "r");
+    if (maps == nullptr) {
+      return result;
+    }
+    char line[4096];
+    while (std::fgets(line, sizeof(line), maps) != nullptr) {
+      const auto permissions = std::strchr(line, ' ');
+      if (permissions != nullptr && permissions[3] == 'x') {
+        result += line;
+      }
+    }
+    std::fclose(maps);
+#endif
+    return result;
+  }
+
+  std::int64_t wallNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+
+  /**
+   * The flusher. Only one thread at a time drains the rings and writes.
+   */
+  struct ViolationLog
+  {
+    std::mutex writeMutex;
+    std::FILE* file = nullptr;
+    std::uint64_t written = 0;
+    std::vector<LogRecord> buffer;
+
+    std::mutex threadMutex;
+    std::condition_variable wakeUp;
+    std::thread thread;
+    bool stopRequested = false;
+
+    static ViolationLog& instance() {
+      // Never destroyed, because other threads may still log on exit
+      static ViolationLog& log = *new ViolationLog;
+      return log;
+    }
+
+    void writeBlock(LogBlockTag tag, const void* payload, std::size_t size, const void* tailData = nullptr, std::size_t tailSize = 0) {
+      const LogBlock block = { tag, static_cast<std::uint32_t>(size + tailSize) };
+      std::fwrite(&block, sizeof(block), 1, file);
+      std::fwrite(payload, size, 1, file);
+      if (tailSize > 0) {
+        std::fwrite(tailData, tailSize, 1, file);
+      }
+    }
+
+    void writeSession() {
+      const LogSession session = { LogSession::currentVersion, sizeof(LogRecord), wallNanoseconds(),
+                                   contract_light::contract_detail::readTicks() };
+      writeBlock(LogBlockTag::Session, &session, sizeof(session));
+      for (auto s : contract_light::contractSites()) {
+        const auto expression = s->expression != nullptr ? s->expression : "";
+        LogSite site = { s->id, static_cast<std::uint8_t>(s->kind), s->level, 0, s->line,
+                         static_cast<std::uint32_t>(std::strlen(s->fileName)),
+                         static_cast<std::uint32_t>(std::strlen(s->function)),
+                         static_cast<std::uint32_t>(std::strlen(expression)), 0 };
+        const auto strings = std::string(s->fileName) + s->function + expression;
+        writeBlock(LogBlockTag::Site, &site, sizeof(site), strings.data(), strings.size());
+      }
+      const auto maps = executableMappings();
+      writeBlock(LogBlockTag::Maps, maps.data(), maps.size());
+      std::fflush(file);
+    }
+
+    void flush() {
+      std::lock_guard<std::mutex> guard(writeMutex);
+      if (file == nullptr) {
+        return;
+      }
+      buffer.clear();
+      for (auto r = rings.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+        const auto tail = r->tail.load(std::memory_order_relaxed);
+        const auto head = r->head.load(std::memory_order_acquire);
+        for (auto i = tail; i != head; ++i) {
+          buffer.push_back(r->records[i & (LogRing::size - 1)]);
+        }
+        r->tail.store(head, std::memory_order_release);
+      }
+      if (buffer.empty()) {
+        return;
+      }
+      const LogSync sync = { wallNanoseconds(), contract_light::contract_detail::readTicks() };
+      writeBlock(LogBlockTag::Records, &sync, sizeof(sync), buffer.data(), buffer.size() * sizeof(LogRecord));
+      std::fflush(file);
+      written += buffer.size();
+    }
+
+    void stop() {
+      {
+        std::lock_guard<std::mutex> guard(threadMutex);
+        stopRequested = true;
+      }
+      wakeUp.notify_all();
+      if (thread.joinable()) {
+        thread.join();
+      }
+      flush();
+      std::lock_guard<std::mutex> guard(writeMutex);
+      if (file != nullptr) {
+        std::fclose(file);
+        file = nullptr;
+      }
+    }
+
+    void run(std::chrono::milliseconds interval) {
+      std::unique_lock<std::mutex> lock(threadMutex);
+      while (!wakeUp.wait_for(lock, interval, [this] { return stopRequested; })) {
+        lock.unlock();
+        flush();
+        lock.lock();
+      }
+    }
+  };
+
+  template <typename T>
+  bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+  }
+
+  struct Mapping
+  {
+    std::uint64_t start;
+    std::uint64_t end;
+    std::uint64_t offset;
+    std::string file;
+  };
+
+  std::vector<Mapping> parseMappings(const std::string& maps) {
+    std::vector<Mapping> result;
+    std::istringstream lines(maps);
+    std::string line;
+    while (std::getline(lines, line)) {
+      Mapping m;
+      char permissions[8];
+      int fileStart = 0;
+      if (std::sscanf(line.c_str(), "%" SCNx64 "-%" SCNx64 " %7s %" SCNx64 " %*s %*s %n",
+                      &m.start, &m.end, permissions, &m.offset, &fileStart) >= 4 && fileStart > 0) {
+        m.file = line.substr(fileStart);
+        result.push_back(m);
+      }
+    }
+    return result;
+  }
+
+  void writeFrames(const LogRecord& r, const std::vector<Mapping>& mappings, bool symbolize, std::ostream& text) {
+    for (std::uint32_t i = 0; i < std::min(r.frameCount, LogRecord::maxFrames); ++i) {
+      const auto address = r.frames[i];
+      text << "    #" << std::dec << i << " 0x" << std::hex << address;
+      auto m = std::find_if(mappings.begin(), mappings.end(), [address](const Mapping& m) {
+        return m.start <= address && address < m.end;
+      });
+      if (m != mappings.end()) {
+        const auto offset = address - m->start + m->offset;
+        // All frames are return addresses, which point behind the call
+        const auto symbol = symbolize ? contract_light::symbolizeFrame(m->file, offset - 1) : std::string();
+        if (!symbol.empty()) {
+          text << " " << symbol;
+        }
+        text << " (" << m->file << "+0x" << offset << ")";
+      }
+      text << std::dec << "\n";
+    }
+  }
+
+  struct DecodedSite
+  {
+    std::string kind;
+    std::string fileName;
+    std::string function;
+    std::string expression;
+    int line;
+  };
+
+  const char* kindName(std::uint32_t kind) {
+    switch (static_cast<contract_light::ContractKind>(kind)) {
+    case contract_light::ContractKind::PreCondition: return "PreCondition";
+    case contract_light::ContractKind::PostCondition: return "PostCondition";
+    case contract_light::ContractKind::Invariant: return "Invariant";
+    case contract_light::ContractKind::Deferred: return "Deferred";
+    }
+    return "Unknown";
+  }
+}
+
+
+namespace contract_light {
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100 {
+    const std::uint32_t contract_detail::LogSession::currentVersion;
+    const std::uint32_t contract_detail::LogRecord::maxFrames;
+
+    void logViolation(const ViolationInfo& info) NOEXCEPT {
+      auto& ring = threadRing();
+      const auto head = ring.head.load(std::memory_order_relaxed);
+      if (head - ring.tail.load(std::memory_order_acquire) == LogRing::size) {
+        droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      auto& record = ring.records[head & (LogRing::size - 1)];
+      record.siteId = info.site->id;
+      record.ticks = info.ticks;
+      record.thread = std::hash<std::thread::id>()(info.thread);
+      record.object = reinterpret_cast<std::uintptr_t>(info.object);
+      record.kind = static_cast<std::uint32_t>(info.kind);
+      record.frameCount = std::min(info.frameCount, LogRecord::maxFrames);
+      for (std::uint32_t i = 0; i < LogRecord::maxFrames; ++i) {
+        record.frames[i] = i < record.frameCount ? reinterpret_cast<std::uintptr_t>(info.frames[i]) : 0;
+      }
+      ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    bool startViolationLog(const char* path, std::chrono::milliseconds interval) {
+      auto& log = ViolationLog::instance();
+      stopViolationLog();
+      std::lock_guard<std::mutex> threadGuard(log.threadMutex);
+      {
+        std::lock_guard<std::mutex> guard(log.writeMutex);
+        log.file = std::fopen(path, "ab");
+        if (log.file == nullptr) {
+          return false;
+        }
+        log.writeSession();
+      }
+      log.stopRequested = false;
+      log.thread = std::thread([&log, interval] { log.run(interval); });
+      return true;
+    }
+
+    void stopViolationLog() {
+      ViolationLog::instance().stop();
+    }
+
+    ViolationLogStatus violationLogStatus() {
+      auto& log = ViolationLog::instance();
+      std::lock_guard<std::mutex> guard(log.writeMutex);
+      ViolationLogStatus status = { log.file != nullptr, log.written, droppedRecords.load(std::memory_order_relaxed) };
+      return status;
+    }
+
+    std::size_t decodeViolationLog(std::istream& log, std::ostream& text, bool symbolize) {
+      std::map<std::uint64_t, DecodedSite> sites;
+      std::vector<Mapping> mappings;
+      LogSession session = {};
+      std::size_t count = 0;
+      LogBlock block;
+      while (readValue(log, block)) {
+        if (block.tag == LogBlockTag::Session && block.size >= sizeof(LogSession)) {
+          readValue(log, session);
+          log.ignore(block.size - sizeof(LogSession));
+          sites.clear();
+          mappings.clear();
+          text << "Session started at " << session.wallNanoseconds / 1000000000 << "."
+               << std::setfill('0') << std::setw(9) << session.wallNanoseconds % 1000000000 << std::setfill(' ') << "\n";
+        }
+        else if (block.tag == LogBlockTag::Site && block.size >= sizeof(LogSite)) {
+          LogSite s;
+          readValue(log, s);
+          std::string strings(block.size - sizeof(LogSite), '\0');
+          log.read(&strings[0], strings.size());
+          if (s.fileNameLength + s.functionLength + s.expressionLength > strings.size()) {
+            break;
+          }
+          auto& site = sites[s.id];
+          site.kind = kindName(s.kind);
+          site.line = s.line;
+          site.fileName = strings.substr(0, s.fileNameLength);
+          site.function = strings.substr(s.fileNameLength, s.functionLength);
+          site.expression = strings.substr(s.fileNameLength + s.functionLength, s.expressionLength);
+        }
+        else if (block.tag == LogBlockTag::Maps) {
+          std::string maps(block.size, '\0');
+          log.read(&maps[0], maps.size());
+          mappings = parseMappings(maps);
+        }
+        else if (block.tag == LogBlockTag::Records && block.size >= sizeof(LogSync) && session.recordSize > 0) {
+          LogSync sync;
+          readValue(log, sync);
+          // The ticks are calibrated between the start of the session and the flush
+          const auto ticksPerNanosecond = sync.wallNanoseconds > session.wallNanoseconds
+            ? static_cast<double>(sync.ticks - session.ticks) / (sync.wallNanoseconds - session.wallNanoseconds)
+            : 0.0;
+          std::vector<char> stored(session.recordSize);
+          for (auto n = (block.size - sizeof(LogSync)) / session.recordSize; n > 0; --n) {
+            if (!log.read(stored.data(), stored.size())) {
+              return count;
+            }
+            LogRecord r = {};
+            std::memcpy(&r, stored.data(), std::min<std::size_t>(stored.size(), sizeof(r)));
+            if (ticksPerNanosecond > 0.0) {
+              text << std::fixed << std::setprecision(6)
+                   << static_cast<std::int64_t>(r.ticks - session.ticks) / ticksPerNanosecond / 1e9 << "s ";
+            }
+            else {
+              text << r.ticks << " ticks ";
+            }
+            text << "thread " << std::hex << r.thread << " " << kindName(r.kind) << " failed";
+            auto site = sites.find(r.siteId);
+            if (site != sites.end()) {
+              text << " in " << site->second.fileName << ":" << std::dec << site->second.line
+                   << " " << site->second.function;
+              if (!site->second.expression.empty()) {
+                text << " " << site->second.expression;
+              }
+              if (site->second.kind != kindName(r.kind)) {
+                text << " at " << site->second.kind;
+              }
+            }
+            else {
+              text << " at site 0x" << r.siteId;
+            }
+            text << " object 0x" << std::hex << r.object << std::dec << "\n";
+            writeFrames(r, mappings, symbolize, text);
+            ++count;
+          }
+        }
+        else {
+          log.ignore(block.size);
+        }
+      }
+      return count;
+    }
+  }
+}
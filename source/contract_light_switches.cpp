@@ -0,0 +1,262 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include "contract_light.hpp"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+  /**
+   * A patch point as emitted by CONTRACT_LIGHT_PATCH_POINT
+   */
+  struct PatchPoint
+  {
+    std::uintptr_t code;
+    std::uintptr_t target;
+    const contract_light::ContractSite* site;
+    const void* classKey;
+    const char* (*module)();
+  };
+}
+
+#ifdef CONTRACT_LIGHT_HAS_STATIC_KEYS
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Generated by the linker for the section contract_light_patch_points, if it exists
+extern "C" {
+  extern const PatchPoint __start_contract_light_patch_points[]
+    __attribute__((weak, visibility("hidden")));
+  extern const PatchPoint __stop_contract_light_patch_points[]
+    __attribute__((weak, visibility("hidden")));
+}
+#endif
+
+namespace {
+  using contract_light::ContractSite;
+  using contract_light::contract_detail::SiteSwitch;
+
+  struct RegisteredSwitch
+  {
+    const ContractSite* site;
+    const void* classKey;
+    const char* module;
+    SiteSwitch* siteSwitch;
+  };
+
+#ifdef CONTRACT_LIGHT_HAS_STATIC_KEYS
+  /**
+   * Rewrites the instruction of the patch point, either to a jump to the
+   * check or to a NOP. The page is writable only for the store and stays
+   * executable, because other threads may run code on it.
+   */
+  bool patch(const PatchPoint& point, bool enabled) {
+    static const auto pageSize = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const auto first = point.code & ~(pageSize - 1);
+    const auto length = ((point.code + 8 + pageSize - 1) & ~(pageSize - 1)) - first;
+    if (mprotect(reinterpret_cast<void*>(first), length, PROT_READ | PROT_WRITE | PROT_EXEC) != 0) {
+      return false;
+    }
+#if defined(__x86_64__)
+    unsigned char instruction[5] = { 0x0f, 0x1f, 0x44, 0x00, 0x00 };
+    if (enabled) {
+      const auto offset = static_cast<std::int32_t>(point.target - (point.code + 5));
+      instruction[0] = 0xe9;
+      std::memcpy(instruction + 1, &offset, sizeof(offset));
+    }
+    // The instruction lies at the start of an aligned word, the rest of the word is kept
+    auto word = reinterpret_cast<std::uint64_t*>(point.code);
+    auto value = __atomic_load_n(word, __ATOMIC_RELAXED);
+    std::memcpy(&value, instruction, sizeof(instruction));
+    __atomic_store_n(word, value, __ATOMIC_RELEASE);
+#else
+    const auto instruction = enabled
+      ? 0x14000000u | (static_cast<std::uint32_t>((point.target - point.code) >> 2) & 0x03ffffffu)
+      : 0xd503201fu;
+    __atomic_store_n(reinterpret_cast<std::uint32_t*>(point.code), instruction, __ATOMIC_RELEASE);
+    __builtin___clear_cache(reinterpret_cast<char*>(point.code), reinterpret_cast<char*>(point.code + 4));
+#endif
+    mprotect(reinterpret_cast<void*>(first), length, PROT_READ | PROT_EXEC);
+    return true;
+  }
+#endif
+
+  /**
+   * A patch point and its current state. Initially every site is on.
+   */
+  struct PatchState
+  {
+    const PatchPoint* point;
+    bool enabled;
+  };
+
+  /**
+   * The configured levels on all tiers. They are only resolved when a level
+   * changes or a site is registered, so the sites just read their own byte.
+   */
+  struct SwitchRegistry
+  {
+    std::mutex mutex;
+    std::uint8_t globalLevel = CONTRACT_LIGHT_LEVEL_AUDIT;
+    std::map<std::string, std::uint8_t> moduleLevels;
+    std::map<const void*, std::uint8_t> classLevels;
+    std::map<std::uint64_t, std::uint8_t> siteLevels;
+    std::vector<RegisteredSwitch> sites;
+    std::vector<PatchState> patchPoints;
+    std::size_t patchFailures = 0;
+
+    SwitchRegistry() {
+#ifdef CONTRACT_LIGHT_HAS_STATIC_KEYS
+      if (__start_contract_light_patch_points != nullptr) {
+        for (auto p = __start_contract_light_patch_points; p != __stop_contract_light_patch_points; ++p) {
+          const PatchState state = { p, true };
+          patchPoints.push_back(state);
+        }
+      }
+#endif
+    }
+
+    static SwitchRegistry& instance() {
+      static SwitchRegistry& registry = *new SwitchRegistry;
+      return registry;
+    }
+
+    /**
+     * The most specific level of the site, plus one
+     */
+    std::uint8_t switchOf(const RegisteredSwitch& s) const {
+      auto site = siteLevels.find(s.site->id);
+      if (site != siteLevels.end()) {
+        return site->second + 1;
+      }
+      auto cls = classLevels.find(s.classKey);
+      if (s.classKey != nullptr && cls != classLevels.end()) {
+        return cls->second + 1;
+      }
+      if (s.module != nullptr) {
+        auto module = moduleLevels.find(s.module);
+        if (module != moduleLevels.end()) {
+          return module->second + 1;
+        }
+      }
+      return globalLevel + 1;
+    }
+
+    void updateSites() {
+      for (const auto& s : sites) {
+        s.siteSwitch->level.store(switchOf(s), std::memory_order_relaxed);
+      }
+#ifdef CONTRACT_LIGHT_HAS_STATIC_KEYS
+      for (auto& p : patchPoints) {
+        const auto& point = *p.point;
+        const RegisteredSwitch s = { point.site, point.classKey, point.module(), nullptr };
+        const bool enabled = point.site->level < switchOf(s);
+        if (enabled != p.enabled) {
+          if (patch(point, enabled)) {
+            p.enabled = enabled;
+          }
+          else {
+            ++patchFailures;
+          }
+        }
+      }
+#endif
+    }
+  };
+
+  std::uint8_t clampLevel(int level) {
+    return static_cast<std::uint8_t>(std::max(CONTRACT_LIGHT_LEVEL_OFF, std::min(level, CONTRACT_LIGHT_LEVEL_AUDIT)));
+  }
+}
+
+
+namespace contract_light {
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100 {
+    void setContractLevel(int level) {
+      auto& registry = SwitchRegistry::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      registry.globalLevel = clampLevel(level);
+      registry.updateSites();
+    }
+
+    void setModuleContractLevel(const char* module, int level) {
+      auto& registry = SwitchRegistry::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      registry.moduleLevels[module] = clampLevel(level);
+      registry.updateSites();
+    }
+
+    void resetModuleContractLevel(const char* module) {
+      auto& registry = SwitchRegistry::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      registry.moduleLevels.erase(module);
+      registry.updateSites();
+    }
+
+    void setSiteContractLevel(std::uint64_t siteId, int level) {
+      auto& registry = SwitchRegistry::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      registry.siteLevels[siteId] = clampLevel(level);
+      registry.updateSites();
+    }
+
+    void resetSiteContractLevel(std::uint64_t siteId) {
+      auto& registry = SwitchRegistry::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      registry.siteLevels.erase(siteId);
+      registry.updateSites();
+    }
+
+    StaticKeyStatus staticKeyStatus() {
+      auto& registry = SwitchRegistry::instance();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      StaticKeyStatus status = { registry.patchPoints.size(), 0, registry.patchFailures };
+      for (const auto& p : registry.patchPoints) {
+        status.enabled += p.enabled ? 1 : 0;
+      }
+      return status;
+    }
+
+    namespace contract_detail {
+      void setClassContractLevel(const void* classKey, int level) {
+        auto& registry = SwitchRegistry::instance();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        registry.classLevels[classKey] = clampLevel(level);
+        registry.updateSites();
+      }
+
+      void resetClassContractLevel(const void* classKey) {
+        auto& registry = SwitchRegistry::instance();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        registry.classLevels.erase(classKey);
+        registry.updateSites();
+      }
+
+      std::uint8_t registerSiteSwitch(const ContractSite& site, SiteSwitch& siteSwitch,
+                                      const void* classKey, const char* module) {
+        auto& registry = SwitchRegistry::instance();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        if (siteSwitch.level.load(std::memory_order_relaxed) == 0) {
+          const RegisteredSwitch s = { &site, classKey, module, &siteSwitch };
+          registry.sites.push_back(s);
+          siteSwitch.level.store(registry.switchOf(s), std::memory_order_relaxed);
+        }
+        return siteSwitch.level.load(std::memory_order_relaxed);
+      }
+    }
+  }
+}
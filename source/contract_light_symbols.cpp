@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include "contract_light.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <elf.h>
+#endif
+
+namespace {
+  struct Symbol
+  {
+    std::uint64_t address;
+    std::uint64_t size;
+    const char* name; // in the string table of the file
+  };
+
+  struct Segment
+  {
+    std::uint64_t offset;
+    std::uint64_t fileSize;
+    std::uint64_t address;
+  };
+
+  /**
+   * The loadable segments and the functions of one ELF file
+   */
+  struct SymbolTable
+  {
+    std::vector<char> content;
+    std::vector<Segment> segments;
+    std::vector<Symbol> symbols; // sorted by address
+
+#ifdef __linux__
+    template <typename T>
+    const T* at(std::uint64_t offset, std::uint64_t count = 1) const {
+      if (offset > content.size() || count > (content.size() - offset) / sizeof(T)) {
+        return nullptr;
+      }
+      return reinterpret_cast<const T*>(content.data() + offset);
+    }
+
+    void addSymbols(const Elf64_Shdr& section, const Elf64_Shdr& strings) {
+      const auto count = section.sh_size / sizeof(Elf64_Sym);
+      auto entries = at<Elf64_Sym>(section.sh_offset, count);
+      if (entries == nullptr || at<char>(strings.sh_offset, strings.sh_size) == nullptr) {
+        return;
+      }
+      for (std::uint64_t i = 0; i < count; ++i) {
+        const auto& e = entries[i];
+        const auto type = ELF64_ST_TYPE(e.st_info);
+        if ((type != STT_FUNC && type != STT_GNU_IFUNC) || e.st_shndx == SHN_UNDEF || e.st_value == 0 ||
+            e.st_name >= strings.sh_size) {
+          continue;
+        }
+        const auto name = content.data() + strings.sh_offset + e.st_name;
+        if (std::memchr(name, '\0', strings.sh_size - e.st_name) == nullptr) {
+          continue;
+        }
+        const Symbol s = { e.st_value, e.st_size, name };
+        symbols.push_back(s);
+      }
+    }
+
+    void load(const std::string& file) {
+      auto f = std::fopen(file.c_str(), "rb");
+      if (f == nullptr) {
+        return;
+      }
+      char chunk[65536];
+      std::size_t n;
+      while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        content.insert(content.end(), chunk, chunk + n);
+      }
+      std::fclose(f);
+
+      auto header = at<Elf64_Ehdr>(0);
+      if (header == nullptr || std::memcmp(header->e_ident, ELFMAG, SELFMAG) != 0 ||
+          header->e_ident[EI_CLASS] != ELFCLASS64 || header->e_phentsize != sizeof(Elf64_Phdr) ||
+          header->e_shentsize != sizeof(Elf64_Shdr)) {
+        return;
+      }
+      if (auto programs = at<Elf64_Phdr>(header->e_phoff, header->e_phnum)) {
+        for (int i = 0; i < header->e_phnum; ++i) {
+          if (programs[i].p_type == PT_LOAD) {
+            const Segment s = { programs[i].p_offset, programs[i].p_filesz, programs[i].p_vaddr };
+            segments.push_back(s);
+          }
+        }
+      }
+      if (auto sections = at<Elf64_Shdr>(header->e_shoff, header->e_shnum)) {
+        for (int i = 0; i < header->e_shnum; ++i) {
+          if ((sections[i].sh_type == SHT_SYMTAB || sections[i].sh_type == SHT_DYNSYM) &&
+              sections[i].sh_link < header->e_shnum) {
+            addSymbols(sections[i], sections[sections[i].sh_link]);
+          }
+        }
+      }
+      std::sort(symbols.begin(), symbols.end(), [](const Symbol& l, const Symbol& r) {
+        return l.address < r.address;
+      });
+    }
+
+    std::string lookup(std::uint64_t fileOffset) const {
+      auto segment = std::find_if(segments.begin(), segments.end(), [fileOffset](const Segment& s) {
+        return s.offset <= fileOffset && fileOffset < s.offset + s.fileSize;
+      });
+      if (segment == segments.end()) {
+        return std::string();
+      }
+      const auto address = fileOffset - segment->offset + segment->address;
+      auto next = std::upper_bound(symbols.begin(), symbols.end(), address, [](std::uint64_t a, const Symbol& s) {
+        return a < s.address;
+      });
+      // Symbols of the same function from .symtab and .dynsym share the address
+      for (auto s = next; s != symbols.begin() && (s - 1)->address == (next - 1)->address; --s) {
+        const auto& symbol = *(s - 1);
+        if (address >= symbol.address + symbol.size) {
+          continue;
+        }
+        int status = 0;
+        auto demangled = abi::__cxa_demangle(symbol.name, nullptr, nullptr, &status);
+        std::ostringstream result;
+        result << (status == 0 && demangled != nullptr ? demangled : symbol.name)
+               << "+0x" << std::hex << address - symbol.address;
+        std::free(demangled);
+        return result.str();
+      }
+      return std::string();
+    }
+#else
+    void load(const std::string&) {}
+
+    std::string lookup(std::uint64_t) const {
+      return std::string();
+    }
+#endif
+  };
+}
+
+
+namespace contract_light {
+#ifdef HAS_INLINE_NAMESPACE
+  inline
+#endif
+  namespace v_100 {
+    std::string symbolizeFrame(const std::string& file, std::uint64_t fileOffset) {
+      static std::mutex mutex;
+      static std::map<std::string, SymbolTable> tables;
+      std::lock_guard<std::mutex> guard(mutex);
+      auto table = tables.find(file);
+      if (table == tables.end()) {
+        table = tables.insert(std::make_pair(file, SymbolTable())).first;
+        table->second.load(file);
+      }
+      return table->second.lookup(fileOffset);
+    }
+  }
+}
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+// Reference functions for the code generation test. This file is compiled
+// in several variants and the disassembly of the variants is compared:
+//   CODEGEN_WITH_CONTRACTS      the contracts are part of the code
+//   CODEGEN_TRIVIAL_PREDICATES  all predicates are replaced by true
+// Without CODEGEN_TRIVIAL_PREDICATES the contracts are real checks.
+// and CONTRACT_LIGHT_LEVEL controls whether the contracts are compiled in.
+
+#include "contract_light.hpp"
+
+#ifdef CODEGEN_WITH_CONTRACTS
+#define CONTRACTS(...) __VA_ARGS__
+#else
+#define CONTRACTS(...)
+#endif
+
+#ifdef CODEGEN_TRIVIAL_PREDICATES
+#define PREDICATE(...) true
+#else
+#define PREDICATE(...) (__VA_ARGS__)
+#endif
+
+namespace
+{
+  class Rect
+  {
+    int w_;
+    int h_;
+  public:
+    void setWidth(int newW) {
+      CONTRACTS(PRECONDITION[&] { return PREDICATE(newW >= 0); };)
+      CONTRACTS(POSTCONDITION[&, this] { return PREDICATE(newW == w_); };)
+      w_ = newW;
+    }
+
+    void setHeight(int newH) {
+      CONTRACTS(PRECONDITION[&] { return PREDICATE(newH >= 0); };)
+      CONTRACTS(POSTCONDITION[&, this] { return PREDICATE(newH == h_); };)
+      h_ = newH;
+    }
+
+    void resize(int newW, int newH) {
+      CONTRACTS(PRECONDITION[&] { return PREDICATE(newW >= 0 && newH >= 0); };)
+      CONTRACTS(POSTCONDITION[&, this] { return PREDICATE(newW == w_ && newH == h_); };)
+      setWidth(newW);
+      setHeight(newH);
+    }
+
+    int area() const {
+      int result;
+      CONTRACTS(POSTCONDITION[&, this] { return PREDICATE(result == w_ * h_); };)
+      result = w_ * h_;
+      return result;
+    }
+
+    bool invariant() const {
+      return PREDICATE(w_ >= 0 && h_ >= 0);
+    }
+
+    CONTRACTS(CONTRACTOR)
+  };
+
+  class Point
+  {
+    int x_;
+  public:
+    void setX(int newX) {
+      CONTRACTS(PRECONDITION[&] { return PREDICATE(newX > -1000); };)
+      x_ = newX;
+    }
+
+    int x() const {
+      CONTRACTS(POSTCONDITION[this] { return PREDICATE(x_ > -1000); };)
+      return x_;
+    }
+  };
+}
+
+extern "C" {
+  void codegen_rect_set_width(Rect* r, int w) { r->setWidth(w); }
+  void codegen_rect_resize(Rect* r, int w, int h) { r->resize(w, h); }
+  int codegen_rect_area(const Rect* r) { return r->area(); }
+  void codegen_point_set_x(Point* p, int x) { p->setX(x); }
+  int codegen_point_x(const Point* p) { return p->x(); }
+}
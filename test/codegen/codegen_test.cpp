@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+// Compares the disassembly of the reference functions compiled without
+// contracts against the ones compiled with disabled contracts and with
+// trivially true contracts. All must result in the same code. With real
+// contracts the failure handling must be moved out of the hot functions.
+// With static keys the sites must be switched by patch points instead of
+// the level byte of the runtime levels.
+//
+// Usage: contract_light_codegen_test <objdump> <plain> <disabled> <trivial> <real>
+//                                    <runtime levels> <static keys>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+
+namespace
+{
+  std::string objdumpCommand;
+  std::string plainLibrary;
+  std::string disabledLibrary;
+  std::string trivialLibrary;
+  std::string realLibrary;
+  std::string runtimeLevelsLibrary;
+  std::string staticKeysLibrary;
+
+  struct FunctionInfo
+  {
+    FunctionInfo() : instructions(0), frameSize(0), callsFailureHandler(false), usesSiteSwitch(false) {}
+
+    int instructions;
+    int frameSize;
+    bool callsFailureHandler;
+    bool usesSiteSwitch;
+  };
+
+  using Disassembly = std::map<std::string, FunctionInfo>;
+
+  std::string runObjdump(const std::string& options, const std::string& library) {
+    const auto command = objdumpCommand + " " + options + " " + library;
+    std::string result;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe == nullptr) {
+      return result;
+    }
+    char buffer[512];
+    while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+      result += buffer;
+    }
+    pclose(pipe);
+    return result;
+  }
+
+  /**
+   * Collects per function the number of instructions (without padding),
+   * the stack frame size and if any handleFailed* function or the level
+   * byte of a site is referenced
+   */
+  Disassembly disassemble(const std::string& library) {
+    static const std::regex functionStart("^[0-9a-f]+ <(codegen_[a-z_]+)>:$");
+    static const std::regex relocation("^\\s+[0-9a-f]+: R_");
+    static const std::regex instruction("^\\s+[0-9a-f]+:\\s+(.*)$");
+    static const std::regex x64Push("^push\\s");
+    // The immediate is shown sign extended, e.g. add $-128 allocates
+    static const std::regex x64Sub("^(sub|add)\\s+\\$0x([0-9a-f]+),%rsp");
+    static const std::regex arm64Push("^stp\\s+.*\\[sp, #-([0-9]+)\\]!");
+    static const std::regex arm64Sub("^sub\\s+sp, sp, #(0x[0-9a-f]+|[0-9]+)");
+
+    Disassembly result;
+    FunctionInfo* current = nullptr;
+    std::smatch match;
+    std::istringstream lines(runObjdump("-d -r -C --no-show-raw-insn", library));
+    std::string line;
+
+    while (std::getline(lines, line)) {
+      if (std::regex_match(line, match, functionStart)) {
+        current = &result[match[1]];
+        continue;
+      }
+      if (line.empty() || line.find('<') == 0) {
+        current = nullptr;
+        continue;
+      }
+      if (current == nullptr) {
+        continue;
+      }
+      if (line.find("handleFailed") != std::string::npos) {
+        current->callsFailureHandler = true;
+      }
+      if (line.find("SiteSwitch") != std::string::npos) {
+        current->usesSiteSwitch = true;
+      }
+      if (std::regex_search(line, relocation) || !std::regex_match(line, match, instruction)) {
+        continue;
+      }
+
+      const std::string code = match[1];
+      if (code.find("nop") != std::string::npos || code.find("xchg   %ax,%ax") == 0) {
+        continue;
+      }
+      ++current->instructions;
+
+      if (std::regex_search(code, x64Push)) {
+        current->frameSize += 8;
+      }
+      else if (std::regex_search(code, match, x64Sub)) {
+        const auto value = static_cast<long long>(std::stoull(match[2], nullptr, 16));
+        const auto allocated = match[1] == "sub" ? value : -value;
+        if (allocated > 0) {
+          current->frameSize += static_cast<int>(allocated);
+        }
+      }
+      else if (std::regex_search(code, match, arm64Push)) {
+        current->frameSize += std::stoi(match[1]);
+      }
+      else if (std::regex_search(code, match, arm64Sub)) {
+        current->frameSize += std::stoi(match[1], nullptr, 0);
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Returns the size of the section in all object files of the library
+   */
+  unsigned long sectionSize(const std::string& library, const std::string& name) {
+    const std::regex header("^\\s*[0-9]+ (\\S+)\\s+([0-9a-f]+)\\s");
+    unsigned long result = 0;
+    std::smatch match;
+    std::istringstream lines(runObjdump("-h", library));
+    std::string line;
+    while (std::getline(lines, line)) {
+      if (std::regex_search(line, match, header) && match[1] == name) {
+        result += std::stoul(match[2], nullptr, 16);
+      }
+    }
+    return result;
+  }
+
+  void expectSameCode(const Disassembly& expected, const Disassembly& actual) {
+    for (const auto& f : expected) {
+      SCOPED_TRACE(f.first);
+      auto it = actual.find(f.first);
+      ASSERT_TRUE(it != actual.end());
+      EXPECT_EQ(f.second.instructions, it->second.instructions);
+      EXPECT_EQ(f.second.frameSize, it->second.frameSize);
+      EXPECT_FALSE(it->second.callsFailureHandler);
+    }
+  }
+}
+
+TEST(ContractCodeGenerationTest, ThatAllReferenceFunctionsAreFound)
+{
+  EXPECT_EQ(5u, disassemble(plainLibrary).size());
+}
+
+TEST(ContractCodeGenerationTest, ThatDisabledContractsGenerateNoCode)
+{
+  expectSameCode(disassemble(plainLibrary), disassemble(disabledLibrary));
+}
+
+TEST(ContractCodeGenerationTest, ThatTriviallyTrueContractsAreOptimizedAway)
+{
+  expectSameCode(disassemble(plainLibrary), disassemble(trivialLibrary));
+}
+
+// Only GCC splits the cold blocks into a separate function part
+#if defined(__GNUC__) && !defined(__clang__)
+TEST(ContractCodeGenerationTest, ThatFailureHandlingIsMovedOutOfTheHotFunctions)
+{
+  auto real = disassemble(realLibrary);
+  EXPECT_EQ(5u, real.size());
+  for (const auto& f : real) {
+    SCOPED_TRACE(f.first);
+    EXPECT_FALSE(f.second.callsFailureHandler);
+  }
+}
+#endif
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+TEST(ContractCodeGenerationTest, ThatStaticKeysLoadNoLevel)
+{
+  auto levels = disassemble(runtimeLevelsLibrary);
+  auto keys = disassemble(staticKeysLibrary);
+  EXPECT_EQ(5u, keys.size());
+  EXPECT_TRUE(levels["codegen_point_set_x"].usesSiteSwitch);
+  for (const auto& f : keys) {
+    SCOPED_TRACE(f.first);
+    EXPECT_FALSE(f.second.usesSiteSwitch);
+  }
+}
+
+TEST(ContractCodeGenerationTest, ThatEveryStaticKeySiteHasAPatchPoint)
+{
+  // A site table entry is one address, a patch point record five
+  const auto sites = sectionSize(staticKeysLibrary, "contract_light_sites") / 8;
+  const auto patchPoints = sectionSize(staticKeysLibrary, "contract_light_patch_points") / 40;
+  EXPECT_LT(0u, sites);
+  EXPECT_LE(sites, patchPoints);
+  EXPECT_EQ(0u, sectionSize(runtimeLevelsLibrary, "contract_light_patch_points"));
+}
+#endif
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  if (argc != 8) {
+    std::cerr << "Usage: " << argv[0] << " <objdump> <plain> <disabled> <trivial> <real> <runtime levels> <static keys>\n";
+    return 1;
+  }
+  objdumpCommand = argv[1];
+  plainLibrary = argv[2];
+  disabledLibrary = argv[3];
+  trivialLibrary = argv[4];
+  realLibrary = argv[5];
+  runtimeLevelsLibrary = argv[6];
+  staticKeysLibrary = argv[7];
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#define CONTRACT_LIGHT_LEVEL CONTRACT_LIGHT_LEVEL_AUDIT
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace
+{
+  class Heap
+  {
+  public:
+    Heap() : invariantCalled(0), auditCalled(0) {}
+
+    void push(int v) {
+      PRECONDITION[] { return true; };
+      values.push_back(v);
+      std::push_heap(values.begin(), values.end());
+    }
+
+    void pushAudited(int v) {
+      PRECONDITION_AUDIT[] { return true; };
+      push(v);
+    }
+
+    int top() const {
+      PRECONDITION[this] { return !values.empty(); };
+      return values.front();
+    }
+
+    bool invariant() const {
+      ++invariantCalled;
+      return true;
+    }
+
+    bool audit_invariant() const {
+      ++auditCalled;
+      return std::is_heap(values.begin(), values.end());
+    }
+
+    std::vector<int> values;
+    mutable int invariantCalled;
+    mutable int auditCalled;
+
+    CONTRACTOR
+  };
+
+  class EveryTenthMutationHeap : public Heap
+  {
+  public:
+    void push(int v) {
+      PRECONDITION[] { return true; };
+      values.push_back(v);
+      std::push_heap(values.begin(), values.end());
+    }
+
+    int top() const {
+      PRECONDITION[this] { return !values.empty(); };
+      return values.front();
+    }
+
+    bool invariant() const { return Heap::invariant(); }
+    bool audit_invariant() const { return Heap::audit_invariant(); }
+
+    CONTRACTOR
+    CONTRACT_AUDIT_SCHEDULE(contract_light::AuditEveryNthMutation<10>)
+  };
+
+  class HourlyHeap : public Heap
+  {
+  public:
+    void push(int v) {
+      PRECONDITION[] { return true; };
+      values.push_back(v);
+      std::push_heap(values.begin(), values.end());
+    }
+
+    bool invariant() const { return Heap::invariant(); }
+    bool audit_invariant() const { return Heap::audit_invariant(); }
+
+    CONTRACTOR
+    CONTRACT_AUDIT_SCHEDULE(contract_light::AuditEveryInterval<3600 * 1000>)
+  };
+
+  int invariantFailed = 0;
+  void countingInvariantHandler(const char*, int) {
+    ++invariantFailed;
+  }
+
+  class ContractAuditInvariantTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override {
+      invariantFailed = 0;
+      contract_light::setHandlerFailedInvariant(&countingInvariantHandler);
+    }
+  };
+}
+
+TEST_F(ContractAuditInvariantTest, ThatOnlyAuditContractsCheckTheAuditInvariantWithoutSchedule)
+{
+  Heap sut;
+  for (int i = 0; i < 10; ++i) {
+    sut.push(i);
+  }
+  sut.top();
+  EXPECT_EQ(11, sut.invariantCalled);
+  EXPECT_EQ(0, sut.auditCalled);
+
+  sut.pushAudited(42);
+  EXPECT_EQ(1, sut.auditCalled);
+}
+
+TEST_F(ContractAuditInvariantTest, ThatTheAuditInvariantIsCheckedOnEveryNthMutation)
+{
+  EveryTenthMutationHeap sut;
+  for (int i = 0; i < 100; ++i) {
+    sut.push(i);
+    sut.top();
+  }
+  EXPECT_EQ(200, sut.invariantCalled);
+  EXPECT_EQ(10, sut.auditCalled);
+}
+
+TEST_F(ContractAuditInvariantTest, ThatTheAuditInvariantIsCheckedOncePerInterval)
+{
+  HourlyHeap sut;
+  for (int i = 0; i < 100; ++i) {
+    sut.push(i);
+  }
+  EXPECT_EQ(100, sut.invariantCalled);
+  EXPECT_EQ(1, sut.auditCalled);
+}
+
+TEST_F(ContractAuditInvariantTest, ThatAFailingAuditInvariantIsReported)
+{
+  EveryTenthMutationHeap sut;
+  for (int i = 0; i < 9; ++i) {
+    sut.push(i);
+  }
+  sut.values.front() = -1;
+  sut.push(100);
+  EXPECT_EQ(1, invariantFailed);
+}
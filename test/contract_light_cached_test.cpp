@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+namespace
+{
+  class ReadMostly
+  {
+  public:
+    ReadMostly() : x(0), invariantCalled(0) {}
+
+    void setX(int newX) {
+      PRECONDITION[&] { return newX >= 0; };
+      x = newX;
+    }
+
+    int getX() const {
+      PRECONDITION[] { return true; };
+      return x;
+    }
+
+    int getTwice() const {
+      PRECONDITION[] { return true; };
+      return getX() + getX();
+    }
+
+    bool invariant() const {
+      ++invariantCalled;
+      return x >= 0;
+    }
+
+    int x;
+    mutable int invariantCalled;
+
+    CONTRACTOR_CACHED
+  };
+
+  int invariantFailed = 0;
+  void countingInvariantHandler(const char*, int) {
+    ++invariantFailed;
+  }
+
+  class ContractCachedInvariantTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override {
+      invariantFailed = 0;
+      contract_light::setHandlerFailedInvariant(&countingInvariantHandler);
+    }
+  };
+}
+
+TEST_F(ContractCachedInvariantTest, ThatAConstCallChecksTheInvariantOnlyOnceWithoutModification)
+{
+  ReadMostly sut;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(0, sut.getX());
+  }
+  EXPECT_EQ(1, sut.invariantCalled);
+}
+
+TEST_F(ContractCachedInvariantTest, ThatAModificationInvalidatesTheCachedCheck)
+{
+  ReadMostly sut;
+  sut.getX();
+  sut.setX(1);
+  EXPECT_EQ(2, sut.invariantCalled);
+  sut.getX();
+  sut.getTwice();
+  EXPECT_EQ(2, sut.invariantCalled);
+  sut.setX(2);
+  sut.getX();
+  EXPECT_EQ(3, sut.invariantCalled);
+}
+
+TEST_F(ContractCachedInvariantTest, ThatAFailedCheckIsNotCached)
+{
+  ReadMostly sut;
+  sut.x = -1; // Modification outside of a guarded call
+  sut.getX();
+  sut.getX();
+  EXPECT_EQ(2, invariantFailed);
+  EXPECT_EQ(2, sut.invariantCalled);
+}
@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+namespace
+{
+  struct Width {};
+  struct Height {};
+  struct Name {};
+  struct From {};
+  struct To {};
+
+  class Shape
+  {
+  public:
+    Shape() : w(1), h(1), widthChecked(0), heightChecked(0), areaChecked(0) {}
+
+    void setWidth(int newW) {
+      MODIFIES(Width);
+      PRECONDITION[&] { return newW > 0; };
+      w = newW;
+    }
+
+    void setHeight(int newH) {
+      MODIFIES(Height);
+      PRECONDITION[&] { return newH > 0; };
+      h = newH;
+    }
+
+    void resize(int newW, int newH) {
+      MODIFIES(Width, Height);
+      PRECONDITION[&] { return newW > 0 && newH > 0; };
+      w = newW;
+      h = newH;
+    }
+
+    void rename() {
+      MODIFIES(Name);
+      INVARIANT;
+    }
+
+    void reset() {
+      PRECONDITION[] { return true; };
+      w = 1;
+      h = 1;
+    }
+
+    void flipHeight() {
+      MODIFIES(Height);
+      INVARIANT;
+      h = -h;
+    }
+
+    void widenAndFlip(int newW) {
+      MODIFIES(Width);
+      PRECONDITION[&] { return newW > 0; };
+      w = newW;
+      flipHeight();
+    }
+
+    int area() const {
+      PRECONDITION[] { return true; };
+      return w * h;
+    }
+
+    void widenToArea(int newArea) {
+      MODIFIES(Width);
+      PRECONDITION[&] { return newArea > 0; };
+      w = newArea / area();
+    }
+
+    bool invariant() const {
+      return contract_light::checkInvariantClauses(*this);
+    }
+
+    int w;
+    int h;
+    mutable int widthChecked;
+    mutable int heightChecked;
+    mutable int areaChecked;
+
+  private:
+    bool positiveWidth() const { ++widthChecked; return w > 0; }
+    bool positiveHeight() const { ++heightChecked; return h > 0; }
+    bool limitedArea() const { ++areaChecked; return w * h <= 100; }
+
+    CONTRACTOR
+    CONTRACT_INVARIANT_CLAUSES(
+      CONTRACT_CLAUSE(Shape::positiveWidth, Width),
+      CONTRACT_CLAUSE(Shape::positiveHeight, Height),
+      CONTRACT_CLAUSE(Shape::limitedArea, Width, Height))
+  };
+
+  /**
+   * Tracks the nesting per thread instead of per object
+   */
+  class Line
+  {
+  public:
+    Line() : from(0), to(1) {}
+
+    void flipTo() {
+      MODIFIES(To);
+      INVARIANT;
+      to = -to;
+    }
+
+    void moveAndFlip(int newFrom) {
+      MODIFIES(From);
+      INVARIANT;
+      from = newFrom;
+      flipTo();
+    }
+
+    bool invariant() const {
+      return contract_light::checkInvariantClauses(*this);
+    }
+
+    int from;
+    int to;
+
+  private:
+    bool positiveTo() const { return to > 0; }
+    bool nonNegativeFrom() const { return from >= 0; }
+
+    CONTRACTOR_THREAD_LOCAL
+    CONTRACT_INVARIANT_CLAUSES(
+      CONTRACT_CLAUSE(Line::positiveTo, To),
+      CONTRACT_CLAUSE(Line::nonNegativeFrom, From))
+  };
+
+  int invariantFailed = 0;
+  void countingInvariantHandler(const char*, int) {
+    ++invariantFailed;
+  }
+
+  class ContractClausesTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override {
+      invariantFailed = 0;
+      contract_light::setHandlerFailedInvariant(&countingInvariantHandler);
+    }
+  };
+}
+
+TEST_F(ContractClausesTest, ThatOnlyTheClausesOfTheModifiedFieldsAreChecked)
+{
+  Shape sut;
+  sut.setWidth(2);
+  EXPECT_EQ(1, sut.widthChecked);
+  EXPECT_EQ(0, sut.heightChecked);
+  EXPECT_EQ(1, sut.areaChecked);
+
+  sut.setHeight(3);
+  EXPECT_EQ(1, sut.widthChecked);
+  EXPECT_EQ(1, sut.heightChecked);
+  EXPECT_EQ(2, sut.areaChecked);
+}
+
+TEST_F(ContractClausesTest, ThatAllDependentClausesOfSeveralFieldsAreChecked)
+{
+  Shape sut;
+  sut.resize(2, 3);
+  EXPECT_EQ(1, sut.widthChecked);
+  EXPECT_EQ(1, sut.heightChecked);
+  EXPECT_EQ(1, sut.areaChecked);
+}
+
+TEST_F(ContractClausesTest, ThatNoClauseIsCheckedForAnUnrelatedField)
+{
+  Shape sut;
+  sut.rename();
+  EXPECT_EQ(0, sut.widthChecked + sut.heightChecked + sut.areaChecked);
+}
+
+TEST_F(ContractClausesTest, ThatTheCompleteInvariantIsCheckedWithoutModifies)
+{
+  Shape sut;
+  sut.reset();
+  EXPECT_EQ(1, sut.widthChecked);
+  EXPECT_EQ(1, sut.heightChecked);
+  EXPECT_EQ(1, sut.areaChecked);
+}
+
+TEST_F(ContractClausesTest, ThatAFailingClauseIsReported)
+{
+  Shape sut;
+  sut.setHeight(10);
+  sut.setWidth(20);
+  EXPECT_EQ(1, invariantFailed);
+}
+
+TEST_F(ContractClausesTest, ThatTheFieldsOfANestedModifyingCallAreChecked)
+{
+  Shape sut;
+  sut.widenAndFlip(2);
+  EXPECT_EQ(1, invariantFailed);
+  EXPECT_EQ(1, sut.heightChecked);
+
+  // Only the next outermost call after the nested one checks all clauses
+  sut.flipHeight();
+  invariantFailed = 0;
+  sut.setWidth(3);
+  EXPECT_EQ(0, invariantFailed);
+  EXPECT_EQ(2, sut.heightChecked);
+}
+
+TEST_F(ContractClausesTest, ThatANestedConstCallKeepsTheSelectedClauses)
+{
+  Shape sut;
+  sut.widenToArea(4);
+  EXPECT_EQ(4, sut.w);
+  EXPECT_EQ(0, sut.heightChecked);
+  EXPECT_EQ(0, invariantFailed);
+}
+
+TEST_F(ContractClausesTest, ThatTheFieldsOfANestedModifyingCallAreCheckedPerThread)
+{
+  Line sut;
+  sut.moveAndFlip(1);
+  EXPECT_EQ(1, invariantFailed);
+}
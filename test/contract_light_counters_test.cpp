@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#define CONTRACT_LIGHT_COUNTERS
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  class CountedClass
+  {
+  public:
+    CountedClass() : x(0), valid(true) {}
+
+    void setX(int newX) {
+      PRECONDITION[&] { return newX >= 0; };
+      POSTCONDITION[&, this] { return x == newX; };
+      x = newX;
+    }
+
+    void check() const {
+      INVARIANT;
+    }
+
+    bool invariant() const {
+      return valid;
+    }
+
+    int x;
+    bool valid;
+
+    CONTRACTOR
+  };
+
+  void ignoreFailure(const char*, int) {}
+
+  /**
+   * Returns the merged counters of the site of the given kind in this file
+   */
+  contract_light::SiteSnapshot countersOf(contract_light::ContractKind kind) {
+    contract_light::SiteSnapshot result = { nullptr, 0, 0, 0 };
+    for (const auto& s : contract_light::snapshot()) {
+      if (s.site->kind == kind && std::strstr(s.site->fileName, "contract_light_counters_test") != nullptr) {
+        result.site = s.site;
+        result.evaluations += s.evaluations;
+        result.failures += s.failures;
+        result.invariantChecks += s.invariantChecks;
+      }
+    }
+    return result;
+  }
+
+  class ContractCountersTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override {
+      contract_light::setHandlerFailedPreCondition(&ignoreFailure);
+      contract_light::setHandlerFailedInvariant(&ignoreFailure);
+      pre = countersOf(contract_light::ContractKind::PreCondition);
+      post = countersOf(contract_light::ContractKind::PostCondition);
+      inv = countersOf(contract_light::ContractKind::Invariant);
+    }
+
+    contract_light::SiteSnapshot pre;
+    contract_light::SiteSnapshot post;
+    contract_light::SiteSnapshot inv;
+  };
+}
+
+TEST_F(ContractCountersTest, ThatEvaluationsAndInvariantChecksAreCountedPerSite)
+{
+  CountedClass sut;
+  for (int i = 0; i < 10; ++i) {
+    sut.setX(i);
+  }
+  sut.check();
+
+  const auto preNow = countersOf(contract_light::ContractKind::PreCondition);
+  ASSERT_TRUE(preNow.site != nullptr);
+  EXPECT_EQ(10u, preNow.evaluations - pre.evaluations);
+  EXPECT_EQ(0u, preNow.failures - pre.failures);
+  // The precondition guard is destroyed last, so it checks the invariant
+  EXPECT_EQ(10u, preNow.invariantChecks - pre.invariantChecks);
+
+  const auto postNow = countersOf(contract_light::ContractKind::PostCondition);
+  EXPECT_EQ(10u, postNow.evaluations - post.evaluations);
+  EXPECT_EQ(0u, postNow.invariantChecks - post.invariantChecks);
+
+  const auto invNow = countersOf(contract_light::ContractKind::Invariant);
+  EXPECT_EQ(0u, invNow.evaluations - inv.evaluations);
+  EXPECT_EQ(1u, invNow.invariantChecks - inv.invariantChecks);
+}
+
+TEST_F(ContractCountersTest, ThatFailuresAreCountedPerSite)
+{
+  CountedClass sut;
+  sut.setX(-1);
+  sut.setX(-2);
+  sut.valid = false;
+  sut.check();
+
+  EXPECT_EQ(2u, countersOf(contract_light::ContractKind::PreCondition).failures - pre.failures);
+  EXPECT_EQ(1u, countersOf(contract_light::ContractKind::Invariant).failures - inv.failures);
+}
+
+TEST_F(ContractCountersTest, ThatTheCountersOfAllThreadsAreMerged)
+{
+  const int threads = 4;
+  const int calls = 1000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([] {
+      CountedClass sut;
+      for (int i = 0; i < calls; ++i) {
+        sut.setX(i);
+      }
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+
+  // The threads have finished, so their shards were folded into the totals
+  EXPECT_EQ(static_cast<std::uint64_t>(threads * calls),
+    countersOf(contract_light::ContractKind::PreCondition).evaluations - pre.evaluations);
+}
+
+TEST_F(ContractCountersTest, ThatTheSnapshotIsSortedByFileAndLine)
+{
+  CountedClass sut;
+  sut.setX(1);
+  const auto sites = contract_light::snapshot();
+  ASSERT_FALSE(sites.empty());
+  for (std::size_t i = 1; i < sites.size(); ++i) {
+    const auto cmp = std::strcmp(sites[i - 1].site->fileName, sites[i].site->fileName);
+    EXPECT_TRUE(cmp < 0 || (cmp == 0 && sites[i - 1].site->line <= sites[i].site->line));
+  }
+}
@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#define CONTRACT_LIGHT_DEFERRED_AUDIT
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  std::atomic<int> checksEvaluated(0);
+
+  class SortedBuffer
+  {
+  public:
+    SortedBuffer() : values(std::make_shared<std::vector<int>>()) {}
+
+    void append(int v) {
+      auto next = std::make_shared<std::vector<int>>(*values);
+      next->push_back(v);
+      values = next;
+      std::shared_ptr<const std::vector<int>> snapshot = values;
+      DEFERRED_AUDIT[snapshot] {
+        ++checksEvaluated;
+        for (std::size_t i = 1; i < snapshot->size(); ++i) {
+          if ((*snapshot)[i - 1] > (*snapshot)[i]) {
+            return false;
+          }
+        }
+        return true;
+      };
+    }
+
+    void set(int v) {
+      x = v;
+      const int captured = x;
+      DEFERRED_AUDIT[captured] { ++checksEvaluated; return captured >= 0; };
+    }
+
+    // The text must outlive the check, e.g. a literal
+    void parse(const char* text) {
+      DEFERRED_AUDIT[text] { ++checksEvaluated; return std::stoi(text) >= 0; };
+    }
+
+    std::shared_ptr<std::vector<int>> values;
+    int x;
+  };
+
+  std::atomic<int> deferredFailed(0);
+  std::thread::id failedThread;
+  const contract_light::ContractSite* failedSite = nullptr;
+
+  void recordingDeferredHandler(const contract_light::ContractSite& site, std::thread::id thread) {
+    ++deferredFailed;
+    failedThread = thread;
+    failedSite = &site;
+  }
+
+  class ContractDeferredTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override {
+      contract_light::checkDeferredContracts();
+      checksEvaluated = 0;
+      deferredFailed = 0;
+      failedSite = nullptr;
+      contract_light::setHandlerFailedDeferred(&recordingDeferredHandler);
+    }
+
+    void TearDown() override {
+      contract_light::stopDeferredChecker();
+    }
+  };
+}
+
+TEST_F(ContractDeferredTest, ThatTheCheckIsOnlyEvaluatedLater)
+{
+  SortedBuffer sut;
+  sut.append(1);
+  sut.append(2);
+  EXPECT_EQ(0, checksEvaluated);
+
+  EXPECT_EQ(2u, contract_light::checkDeferredContracts());
+  EXPECT_EQ(2, checksEvaluated);
+  EXPECT_EQ(0, deferredFailed);
+}
+
+TEST_F(ContractDeferredTest, ThatTheCapturedValuesAreChecked)
+{
+  SortedBuffer sut;
+  sut.set(-1);
+  sut.set(1);
+  contract_light::checkDeferredContracts();
+  EXPECT_EQ(2, checksEvaluated);
+  EXPECT_EQ(1, deferredFailed);
+}
+
+TEST_F(ContractDeferredTest, ThatAFailureReportsTheSiteAndTheCapturingThread)
+{
+  SortedBuffer sut;
+  std::thread::id producer;
+  std::thread t([&] {
+    producer = std::this_thread::get_id();
+    sut.append(2);
+    sut.append(1);
+  });
+  t.join();
+
+  contract_light::checkDeferredContracts();
+  ASSERT_EQ(1, deferredFailed);
+  EXPECT_EQ(producer, failedThread);
+  ASSERT_NE(nullptr, failedSite);
+  EXPECT_EQ(contract_light::ContractKind::Deferred, failedSite->kind);
+  EXPECT_STREQ("append", failedSite->function);
+}
+
+TEST_F(ContractDeferredTest, ThatChecksAreDroppedWhenTheQueueIsFull)
+{
+  const auto before = contract_light::deferredStatus();
+  SortedBuffer sut;
+  const auto size = static_cast<int>(contract_light::contract_detail::DeferredQueue::size);
+  for (int i = 0; i < size + 10; ++i) {
+    sut.set(i);
+  }
+  const auto after = contract_light::deferredStatus();
+  EXPECT_EQ(10u, after.dropped - before.dropped);
+
+  EXPECT_EQ(static_cast<std::size_t>(size), contract_light::checkDeferredContracts());
+  sut.set(1);
+  EXPECT_EQ(1u, contract_light::checkDeferredContracts());
+}
+
+TEST_F(ContractDeferredTest, ThatTheCheckerThreadEvaluatesTheChecksOfAllThreads)
+{
+  const auto before = contract_light::deferredStatus();
+  contract_light::startDeferredChecker();
+  EXPECT_TRUE(contract_light::deferredStatus().running);
+
+  std::vector<std::thread> producers;
+  for (int t = 0; t < 4; ++t) {
+    producers.emplace_back([] {
+      SortedBuffer sut;
+      for (int i = 0; i < 100; ++i) {
+        sut.set(i);
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+
+  contract_light::stopDeferredChecker();
+  const auto after = contract_light::deferredStatus();
+  EXPECT_FALSE(after.running);
+  EXPECT_EQ(400u, (after.checked - before.checked) + (after.dropped - before.dropped));
+  EXPECT_EQ(0, deferredFailed);
+}
+
+TEST_F(ContractDeferredTest, ThatAThrowingCheckIsReportedAsFailure)
+{
+  SortedBuffer sut;
+  sut.parse("no number");
+  sut.set(1);
+  EXPECT_EQ(2u, contract_light::checkDeferredContracts());
+  EXPECT_EQ(2, checksEvaluated);
+  ASSERT_EQ(1, deferredFailed);
+  EXPECT_STREQ("parse", failedSite->function);
+
+  contract_light::startDeferredChecker();
+  sut.parse("no number");
+  sut.set(1);
+  contract_light::stopDeferredChecker();
+  EXPECT_EQ(4, checksEvaluated);
+  EXPECT_EQ(2, deferredFailed);
+}
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#define CONTRACT_LIGHT_PROFILING
+#define CONTRACT_LIGHT_SAMPLING
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace
+{
+  class GovernedClass
+  {
+  public:
+    GovernedClass() : values(2000, 1), expensiveCalled(0), cheapCalled(0) {}
+
+    void cheap() {
+      PRECONDITION[this] { ++cheapCalled; return true; };
+    }
+
+    void expensive() {
+      PRECONDITION[this] {
+        ++expensiveCalled;
+        volatile int sum = 0;
+        for (auto v : values) {
+          sum = sum + v;
+        }
+        return sum > 0;
+      };
+    }
+
+    std::vector<int> values;
+    int expensiveCalled;
+    int cheapCalled;
+  };
+
+  std::uint64_t ticksOfThisFile() {
+    std::uint64_t result = 0;
+    for (const auto& c : contract_light::mostExpensiveSites(std::numeric_limits<std::size_t>::max())) {
+      if (std::strstr(c.site->fileName, "contract_light_governor_test") != nullptr) {
+        result += c.totalTicks;
+      }
+    }
+    return result;
+  }
+
+  const std::uint64_t idleTicks = std::numeric_limits<std::uint32_t>::max() * 1000ull;
+
+  class ContractGovernorTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override {
+      // Starts with a step without load, so only the following calls count
+      contract_light::governContracts(idleTicks);
+      contract_light::resetGovernor();
+    }
+
+    void TearDown() override {
+      contract_light::stopGovernor();
+      contract_light::resetGovernor();
+    }
+  };
+}
+
+TEST_F(ContractGovernorTest, ThatTheCostliestSiteIsThrottledFirst)
+{
+  GovernedClass sut;
+  const auto before = ticksOfThisFile();
+  for (int i = 0; i < 100; ++i) {
+    sut.cheap();
+    sut.expensive();
+  }
+  const auto spent = ticksOfThisFile() - before;
+
+  // Contracts used 3% of the CPU, halving the expensive site is enough
+  contract_light::governContracts(spent * 100 / 3);
+
+  const auto status = contract_light::governorStatus();
+  EXPECT_GT(status.cpuShare, 0.02);
+  ASSERT_EQ(1u, status.throttled.size());
+  EXPECT_EQ(2u, status.throttled[0].throttle);
+  EXPECT_GT(status.throttled[0].cpuShare, 0.01);
+  EXPECT_STREQ("expensive", status.throttled[0].site->function);
+
+  sut.expensiveCalled = 0;
+  sut.cheapCalled = 0;
+  for (int i = 0; i < 100; ++i) {
+    sut.cheap();
+    sut.expensive();
+  }
+  EXPECT_EQ(100, sut.cheapCalled);
+  EXPECT_EQ(50, sut.expensiveCalled);
+}
+
+TEST_F(ContractGovernorTest, ThatTheThrottleIsRemovedWhenTheLoadDrops)
+{
+  GovernedClass sut;
+  const auto before = ticksOfThisFile();
+  for (int i = 0; i < 100; ++i) {
+    sut.expensive();
+  }
+  contract_light::governContracts((ticksOfThisFile() - before) * 10);
+  ASSERT_FALSE(contract_light::governorStatus().throttled.empty());
+
+  for (int i = 0; i < 20 && !contract_light::governorStatus().throttled.empty(); ++i) {
+    contract_light::governContracts(idleTicks);
+  }
+  EXPECT_TRUE(contract_light::governorStatus().throttled.empty());
+
+  sut.expensiveCalled = 0;
+  sut.expensive();
+  sut.expensive();
+  EXPECT_EQ(2, sut.expensiveCalled);
+}
+
+TEST_F(ContractGovernorTest, ThatTheGovernorThreadCanBeStartedAndStopped)
+{
+  contract_light::GovernorConfig config;
+  config.interval = std::chrono::milliseconds(1);
+  contract_light::startGovernor(config);
+  EXPECT_TRUE(contract_light::governorStatus().running);
+
+  GovernedClass sut;
+  for (int i = 0; i < 1000; ++i) {
+    sut.expensive();
+  }
+
+  contract_light::stopGovernor();
+  EXPECT_FALSE(contract_light::governorStatus().running);
+}
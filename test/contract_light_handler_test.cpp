@@ -0,0 +1,388 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  class TestClassWithFailingPostCondition
+  {
+  public:
+    int x;
+
+    TestClassWithFailingPostCondition() : x(0) {}
+
+    void setX(int newX) {
+      POSTCONDITION[&, this] { return x == newX + 1; };
+      x = newX;
+    }
+  };
+
+  std::atomic<int> handlerACalled(0);
+  std::atomic<int> handlerBCalled(0);
+
+  void postConditionHandlerA(const char*, int) {
+    ++handlerACalled;
+  }
+
+  void postConditionHandlerB(const char*, int) {
+    ++handlerBCalled;
+  }
+
+  struct SubscriberRecord
+  {
+    SubscriberRecord() : called(0), kind(contract_light::ContractKind::Invariant), fileName(nullptr), line(0) {}
+
+    std::atomic<int> called;
+    contract_light::ContractKind kind;
+    const char* fileName;
+    int line;
+  };
+
+  void recordingSubscriber(contract_light::ContractKind kind, const char* fileName, int line, void* userData) {
+    auto record = static_cast<SubscriberRecord*>(userData);
+    ++record->called;
+    record->kind = kind;
+    record->fileName = fileName;
+    record->line = line;
+  }
+
+  void countingSubscriber(contract_light::ContractKind, const char*, int, void* userData) {
+    ++*static_cast<std::atomic<int>*>(userData);
+  }
+}
+
+class ViolationSubscriberTest : public ::testing::Test
+{
+protected:
+  ViolationSubscriberTest() {
+    contract_light::setHandlerFailedPostCondition(&postConditionHandlerA);
+    handlerACalled = 0;
+  }
+
+  TestClassWithFailingPostCondition sut;
+  SubscriberRecord first;
+  SubscriberRecord second;
+};
+
+TEST_F(ViolationSubscriberTest, ThatAllSubscribersAndTheHandlerAreCalledOnAFailure)
+{
+  auto firstId = contract_light::addViolationSubscriber(&recordingSubscriber, &first);
+  auto secondId = contract_light::addViolationSubscriber(&recordingSubscriber, &second);
+  EXPECT_NE(firstId, secondId);
+
+  sut.setX(1);
+
+  EXPECT_EQ(1, handlerACalled);
+  EXPECT_EQ(1, first.called);
+  EXPECT_EQ(1, second.called);
+  EXPECT_EQ(contract_light::ContractKind::PostCondition, first.kind);
+  EXPECT_NE(nullptr, std::strstr(first.fileName, "contract_light_handler_test.cpp"));
+  EXPECT_LT(0, first.line);
+
+  EXPECT_TRUE(contract_light::removeViolationSubscriber(firstId));
+  EXPECT_TRUE(contract_light::removeViolationSubscriber(secondId));
+}
+
+TEST_F(ViolationSubscriberTest, ThatARemovedSubscriberIsNotCalledAnymore)
+{
+  auto id = contract_light::addViolationSubscriber(&recordingSubscriber, &first);
+  EXPECT_TRUE(contract_light::removeViolationSubscriber(id));
+  EXPECT_FALSE(contract_light::removeViolationSubscriber(id));
+
+  sut.setX(1);
+
+  EXPECT_EQ(1, handlerACalled);
+  EXPECT_EQ(0, first.called);
+}
+
+TEST(ViolationHandlerStressTest, ThatHandlersAndSubscribersCanBeReplacedWhileOtherThreadsReport)
+{
+  const int reporters = 4;
+  const int failuresPerReporter = 20000;
+  handlerACalled = 0;
+  handlerBCalled = 0;
+  std::atomic<int> subscriberCalled(0);
+  std::atomic<int> reportersDone(0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < reporters; ++i) {
+    threads.emplace_back([&] {
+      TestClassWithFailingPostCondition sut;
+      for (int j = 0; j < failuresPerReporter; ++j) {
+        sut.setX(j);
+      }
+      ++reportersDone;
+    });
+  }
+
+  int updates = 0;
+  while (reportersDone < reporters) {
+    contract_light::setHandlerFailedPostCondition(updates % 2 == 0 ? &postConditionHandlerB : &postConditionHandlerA);
+    auto id = contract_light::addViolationSubscriber(&countingSubscriber, &subscriberCalled);
+    std::this_thread::yield();
+    contract_light::removeViolationSubscriber(id);
+    ++updates;
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(reporters * failuresPerReporter, handlerACalled + handlerBCalled);
+  EXPECT_GE(reporters * failuresPerReporter, subscriberCalled);
+}
+
+TEST_F(ViolationSubscriberTest, ThatReplacedSubscriberSnapshotsAreFreed)
+{
+  for (int i = 0; i < 1000; ++i) {
+    auto id = contract_light::addViolationSubscriber(&recordingSubscriber, &first);
+    sut.setX(1);
+    contract_light::removeViolationSubscriber(id);
+  }
+  EXPECT_EQ(1000, first.called);
+  EXPECT_EQ(0u, contract_light::contract_detail::retiredSubscriberSnapshots());
+}
+
+namespace
+{
+  class TestClassWithInvariant
+  {
+  public:
+    int x;
+
+    TestClassWithInvariant() : x(0) {}
+
+    void setX(int newX) {
+      PRECONDITION[&] { return newX >= 0; };
+      x = newX;
+    }
+
+    bool invariant() const {
+      return x != 42;
+    }
+
+    CONTRACTOR
+  };
+
+  std::vector<contract_light::ViolationInfo> violations;
+
+  void recordingHandler(const contract_light::ViolationInfo& info) {
+    violations.push_back(info);
+  }
+
+  int legacyPreConditionCalled = 0;
+
+  void legacyPreConditionHandler(const char*, int) {
+    ++legacyPreConditionCalled;
+  }
+}
+
+class ViolationInfoTest : public ::testing::Test
+{
+protected:
+  ViolationInfoTest() {
+    violations.clear();
+    contract_light::setViolationHandler(contract_light::ContractKind::PreCondition, &recordingHandler);
+    contract_light::setViolationHandler(contract_light::ContractKind::Invariant, &recordingHandler);
+  }
+
+  TestClassWithInvariant sut;
+};
+
+TEST_F(ViolationInfoTest, ThatTheHandlerGetsTheSiteTheObjectAndTheThread)
+{
+  sut.setX(-1);
+
+  ASSERT_EQ(1u, violations.size());
+  const auto& info = violations.front();
+  EXPECT_EQ(contract_light::ContractKind::PreCondition, info.kind);
+  EXPECT_EQ(contract_light::ContractKind::PreCondition, info.site->kind);
+  EXPECT_EQ(CONTRACT_LIGHT_LEVEL_DEFAULT, info.site->level);
+  EXPECT_STREQ("setX", info.site->function);
+  EXPECT_NE(nullptr, std::strstr(info.site->fileName, "contract_light_handler_test.cpp"));
+  EXPECT_EQ(&sut, info.object);
+  EXPECT_EQ(std::this_thread::get_id(), info.thread);
+  EXPECT_NE(0u, info.ticks);
+}
+
+#if defined(__GNUC__) && !defined(_WIN32)
+TEST_F(ViolationInfoTest, ThatTheCallStackIsCapturedOnlyIfSwitchedOn)
+{
+  sut.setX(-1);
+  contract_light::setViolationStackCapture(false);
+  sut.setX(-1);
+  contract_light::setViolationStackCapture(true);
+
+  ASSERT_EQ(2u, violations.size());
+  EXPECT_LT(1u, violations[0].frameCount);
+  EXPECT_NE(nullptr, violations[0].frames);
+  EXPECT_EQ(0u, violations[1].frameCount);
+}
+#endif
+
+TEST_F(ViolationInfoTest, ThatAFailedInvariantIsReportedWithTheSiteOfTheGuard)
+{
+  sut.setX(42);
+
+  ASSERT_EQ(1u, violations.size());
+  EXPECT_EQ(contract_light::ContractKind::Invariant, violations.front().kind);
+  EXPECT_EQ(contract_light::ContractKind::PreCondition, violations.front().site->kind);
+  EXPECT_EQ(&sut, violations.front().object);
+}
+
+TEST_F(ViolationInfoTest, ThatAHandlerWithTheOldSignatureReplacesTheViolationHandler)
+{
+  contract_light::setHandlerFailedPreCondition(&legacyPreConditionHandler);
+  legacyPreConditionCalled = 0;
+
+  sut.setX(-1);
+
+  EXPECT_EQ(1, legacyPreConditionCalled);
+  EXPECT_TRUE(violations.empty());
+}
+
+namespace
+{
+  std::atomic<int> limitedHandlerCalled(0);
+
+  void countingViolationHandler(const contract_light::ViolationInfo&) {
+    ++limitedHandlerCalled;
+  }
+
+  std::mutex summariesMutex;
+  std::vector<contract_light::ViolationSummary> summaries;
+
+  void recordingSummaryHandler(const contract_light::ViolationSummary& summary) {
+    std::lock_guard<std::mutex> guard(summariesMutex);
+    summaries.push_back(summary);
+  }
+
+  std::uint64_t suppressedInSummaries() {
+    std::lock_guard<std::mutex> guard(summariesMutex);
+    std::uint64_t result = 0;
+    for (const auto& s : summaries) {
+      result += s.suppressed;
+    }
+    return result;
+  }
+}
+
+class ViolationReportLimitTest : public ::testing::Test
+{
+protected:
+  ViolationReportLimitTest() {
+    limitedHandlerCalled = 0;
+    summaries.clear();
+    contract_light::resetViolationReports();
+    contract_light::setViolationHandler(contract_light::ContractKind::PreCondition, &countingViolationHandler);
+    contract_light::setViolationHandler(contract_light::ContractKind::Invariant, &countingViolationHandler);
+    contract_light::setViolationSummaryHandler(&recordingSummaryHandler);
+  }
+
+  ~ViolationReportLimitTest() {
+    contract_light::setViolationReportLimit(0);
+    contract_light::resetViolationReports();
+  }
+
+  TestClassWithInvariant sut;
+};
+
+TEST_F(ViolationReportLimitTest, ThatOnlyTheFirstFailuresArePassedToTheHandler)
+{
+  contract_light::setViolationReportLimit(3, std::chrono::seconds(3600));
+  for (int i = 0; i < 100; ++i) {
+    sut.setX(-1);
+  }
+  EXPECT_EQ(3, limitedHandlerCalled);
+  EXPECT_TRUE(summaries.empty());
+
+  contract_light::flushViolationSummaries();
+  ASSERT_EQ(1u, summaries.size());
+  EXPECT_EQ(97u, summaries.front().suppressed);
+  EXPECT_EQ(contract_light::ContractKind::PreCondition, summaries.front().kind);
+  EXPECT_STREQ("setX", summaries.front().site->function);
+
+  contract_light::flushViolationSummaries();
+  EXPECT_EQ(1u, summaries.size());
+}
+
+TEST_F(ViolationReportLimitTest, ThatTheNextFailureAfterTheIntervalReportsTheSummary)
+{
+  contract_light::setViolationReportLimit(1, std::chrono::seconds(0));
+  for (int i = 0; i < 10; ++i) {
+    sut.setX(-1);
+  }
+  EXPECT_EQ(1, limitedHandlerCalled);
+  EXPECT_LT(0u, suppressedInSummaries());
+  contract_light::flushViolationSummaries();
+  EXPECT_EQ(9u, suppressedInSummaries());
+}
+
+TEST_F(ViolationReportLimitTest, ThatASummaryIsReportedWhenTheIntervalIsOver)
+{
+  contract_light::setViolationReportLimit(1, std::chrono::seconds(1));
+  for (int i = 0; i < 10; ++i) {
+    sut.setX(-1);
+  }
+  EXPECT_EQ(1, limitedHandlerCalled);
+
+  // There is no later failure, so the background thread must report it
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (suppressedInSummaries() < 9u && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(9u, suppressedInSummaries());
+}
+
+TEST_F(ViolationReportLimitTest, ThatEachKindOfASiteHasItsOwnLimit)
+{
+  contract_light::setViolationReportLimit(1, std::chrono::seconds(3600));
+  sut.setX(-1);
+  sut.setX(-1);
+  sut.setX(42);
+  sut.setX(42);
+  EXPECT_EQ(2, limitedHandlerCalled);
+
+  contract_light::resetViolationReports();
+  sut.setX(-1);
+  EXPECT_EQ(3, limitedHandlerCalled);
+}
+
+TEST_F(ViolationReportLimitTest, ThatNoFailureIsLostWhileManyThreadsReport)
+{
+  const int reporters = 4;
+  const int failuresPerReporter = 5000;
+  contract_light::setViolationReportLimit(10, std::chrono::seconds(0));
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < reporters; ++i) {
+    threads.emplace_back([] {
+      TestClassWithInvariant sut;
+      for (int j = 0; j < failuresPerReporter; ++j) {
+        sut.setX(-1);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  contract_light::flushViolationSummaries();
+
+  EXPECT_EQ(10, limitedHandlerCalled);
+  EXPECT_EQ(static_cast<std::uint64_t>(reporters * failuresPerReporter - 10), suppressedInSummaries());
+}
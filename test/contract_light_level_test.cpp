@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#define CONTRACT_LIGHT_LEVEL CONTRACT_LIGHT_LEVEL_OFF
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+namespace
+{
+  class TestClassWithDisabledContracts
+  {
+  public:
+    TestClassWithDisabledContracts()
+      : x(0)
+      , conditionCalled(0)
+      , invariantCalled(0)
+    {}
+
+    ~TestClassWithDisabledContracts() {
+      INVARIANT;
+    }
+
+    void setX(int newX) {
+      PRECONDITION[&, this] { ++conditionCalled; return newX > 0; };
+      PRECONDITION_AUDIT[&, this] { ++conditionCalled; return newX > 0; };
+      POSTCONDITION[&, this] { ++conditionCalled; return newX == x + 1; };
+      POSTCONDITION_AUDIT[&, this] { ++conditionCalled; return newX == x + 1; };
+      INVARIANT_AUDIT;
+      x = newX;
+    }
+
+    void incrementX() {
+      MODIFIES(int);
+      OLD(oldX, readX());
+      POSTCONDITION[&, this] { ++conditionCalled; return x == *oldX + 1; };
+      OLD_AUDIT(auditX, readX());
+      POSTCONDITION_AUDIT[&, this] { ++conditionCalled; return x == *auditX + 1; };
+      x += 2;
+    }
+
+    int nextX() {
+      POSTCONDITION_RESULT[this](int result) { ++conditionCalled; return result == x + 1; };
+      RETURN_CHECKED(x + 2);
+    }
+
+    int readX() const {
+      ++invariantCalled;
+      return x;
+    }
+
+    bool invariant() const {
+      ++invariantCalled;
+      return false;
+    }
+
+    int x;
+    int conditionCalled;
+    mutable int invariantCalled;
+
+    CONTRACTOR
+  };
+}
+
+TEST(ContractLevelOffTest, ThatNoConditionAndNoInvariantIsEvaluated)
+{
+  TestClassWithDisabledContracts sut;
+  EXPECT_NO_THROW(sut.setX(0));
+  EXPECT_EQ(0, sut.conditionCalled);
+  EXPECT_EQ(0, sut.invariantCalled);
+  EXPECT_EQ(0, sut.x);
+}
+
+TEST(ContractLevelOffTest, ThatNoOldValueIsTaken)
+{
+  TestClassWithDisabledContracts sut;
+  sut.incrementX();
+  EXPECT_EQ(0, sut.conditionCalled);
+  EXPECT_EQ(0, sut.invariantCalled);
+  EXPECT_EQ(2, sut.x);
+}
+
+TEST(ContractLevelOffTest, ThatNoResultIsChecked)
+{
+  TestClassWithDisabledContracts sut;
+  EXPECT_EQ(2, sut.nextX());
+  EXPECT_EQ(0, sut.conditionCalled);
+  EXPECT_EQ(0, sut.invariantCalled);
+}
+
+TEST(ContractLevelOffTest, ThatATransactionChecksNoInvariant)
+{
+  TestClassWithDisabledContracts sut;
+  {
+    CONTRACT_TRANSACTION(sut);
+    sut.setX(1);
+  }
+  EXPECT_EQ(0, sut.invariantCalled);
+}
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  const char* const logPath = "contract_light_log_test.bin";
+
+  class LoggedClass
+  {
+  public:
+    void set(int v) {
+      PRECONDITION[v] { return v >= 0; };
+    }
+  };
+
+  std::string decodedLog(std::size_t& records) {
+    std::ifstream log(logPath, std::ios::binary);
+    std::ostringstream text;
+    records = contract_light::decodeViolationLog(log, text);
+    return text.str();
+  }
+
+  std::size_t countOf(const std::string& text, const std::string& pattern) {
+    std::size_t count = 0;
+    for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+      ++count;
+    }
+    return count;
+  }
+
+  class ViolationLogTest : public ::testing::Test
+  {
+  protected:
+    ViolationLogTest()
+      : previousHandler(contract_light::setViolationHandler(contract_light::ContractKind::PreCondition,
+                                                            &contract_light::logViolation)) {
+      std::remove(logPath);
+    }
+
+    ~ViolationLogTest() {
+      contract_light::stopViolationLog();
+      contract_light::setViolationHandler(contract_light::ContractKind::PreCondition, previousHandler);
+      std::remove(logPath);
+    }
+
+    const contract_light::ViolationHandler previousHandler;
+  };
+}
+
+TEST_F(ViolationLogTest, ThatTheViolationsOfAllThreadsAreWrittenAndDecoded)
+{
+  ASSERT_TRUE(contract_light::startViolationLog(logPath, std::chrono::milliseconds(1)));
+  const auto before = contract_light::violationLogStatus();
+  EXPECT_TRUE(before.running);
+
+  const int threads = 4;
+  const int failuresPerThread = 100;
+  std::vector<std::thread> reporters;
+  for (int i = 0; i < threads; ++i) {
+    reporters.emplace_back([] {
+      LoggedClass sut;
+      for (int j = 0; j < failuresPerThread; ++j) {
+        sut.set(-1);
+        if (j % 50 == 0) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+      }
+    });
+  }
+  for (auto& t : reporters) {
+    t.join();
+  }
+  contract_light::stopViolationLog();
+
+  const auto after = contract_light::violationLogStatus();
+  EXPECT_FALSE(after.running);
+  EXPECT_EQ(before.dropped, after.dropped);
+  EXPECT_EQ(static_cast<std::uint64_t>(threads * failuresPerThread), after.written - before.written);
+
+  std::size_t records = 0;
+  const auto text = decodedLog(records);
+  EXPECT_EQ(static_cast<std::size_t>(threads * failuresPerThread), records);
+#ifdef CONTRACT_LIGHT_REGISTERS_SITES
+  EXPECT_EQ(records, countOf(text, "PreCondition failed in "));
+  EXPECT_EQ(records, countOf(text, "contract_light_log_test.cpp"));
+#endif
+}
+
+#if defined(__linux__) && defined(__GNUC__)
+TEST_F(ViolationLogTest, ThatTheCallStacksAreSymbolizedOffline)
+{
+  LoggedClass sut;
+  ASSERT_TRUE(contract_light::startViolationLog(logPath));
+  sut.set(-1);
+  contract_light::stopViolationLog();
+
+  std::size_t records = 0;
+  const auto text = decodedLog(records);
+  EXPECT_EQ(1u, records);
+  EXPECT_EQ(1u, countOf(text, "    #0 0x"));
+  EXPECT_EQ(std::string::npos, text.find("handleFailed")) << text;
+  EXPECT_NE(std::string::npos, text.find("ThatTheCallStacksAreSymbolizedOffline")) << text;
+}
+#endif
+
+TEST_F(ViolationLogTest, ThatEachStartAppendsASession)
+{
+  LoggedClass sut;
+  ASSERT_TRUE(contract_light::startViolationLog(logPath));
+  sut.set(-1);
+  contract_light::stopViolationLog();
+  ASSERT_TRUE(contract_light::startViolationLog(logPath));
+  sut.set(-2);
+  contract_light::stopViolationLog();
+
+  std::size_t records = 0;
+  const auto text = decodedLog(records);
+  EXPECT_EQ(2u, records);
+  EXPECT_EQ(2u, countOf(text, "Session started at "));
+}
+
+TEST_F(ViolationLogTest, ThatRecordsAreDroppedWhenTheRingIsFull)
+{
+  const auto before = contract_light::violationLogStatus();
+  std::thread([] {
+    LoggedClass sut;
+    for (int i = 0; i < 1000; ++i) {
+      sut.set(-1);
+    }
+  }).join();
+  const auto after = contract_light::violationLogStatus();
+  EXPECT_LT(0u, after.dropped - before.dropped);
+
+  // The kept records are written by the next session
+  ASSERT_TRUE(contract_light::startViolationLog(logPath));
+  contract_light::stopViolationLog();
+  EXPECT_EQ(1000u, contract_light::violationLogStatus().written - before.written + (after.dropped - before.dropped));
+}
+
+TEST_F(ViolationLogTest, ThatTheLogHandlerReplacesThePreviousOne)
+{
+  EXPECT_NE(&contract_light::logViolation, previousHandler);
+  EXPECT_EQ(&contract_light::logViolation,
+            contract_light::setViolationHandler(contract_light::ContractKind::PreCondition, nullptr));
+}
+
+TEST_F(ViolationLogTest, ThatTheLogCannotBeStartedWithoutAFile)
+{
+  EXPECT_FALSE(contract_light::startViolationLog("/nonexistent/contract_light.log"));
+  EXPECT_FALSE(contract_light::violationLogStatus().running);
+}
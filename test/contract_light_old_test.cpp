@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#define CONTRACT_LIGHT_SAMPLING
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+  struct CountedCopies
+  {
+    static int copies;
+
+    CountedCopies() {}
+    CountedCopies(const CountedCopies&) { ++copies; }
+    CountedCopies(CountedCopies&&) {}
+  };
+
+  int CountedCopies::copies = 0;
+
+  class Stack
+  {
+  public:
+    Stack() : sizeCalled(0) {}
+
+    void push(int v) {
+      OLD(oldSize, size());
+      POSTCONDITION[&, this] { return values.size() == *oldSize + 1; };
+      values.push_back(v);
+    }
+
+    void pushTwice(int v) {
+      OLD(oldSize, size());
+      POSTCONDITION[&, this] { return values.size() == *oldSize + 1; };
+      values.push_back(v);
+      values.push_back(v);
+    }
+
+    void append(const std::vector<int>& other) {
+      OLD(oldValues, values);
+      POSTCONDITION[&, this] { return std::equal(oldValues->begin(), oldValues->end(), values.begin()); };
+      values.insert(values.end(), other.begin(), other.end());
+    }
+
+    void pushAll(const std::vector<int>& other) {
+      OLD(oldSize, size());
+      POSTCONDITION[&, this] { return values.size() == *oldSize + other.size(); };
+      for (auto v : other) {
+        push(v);
+      }
+    }
+
+    void copyMember() {
+      OLD(oldCounted, counted);
+      POSTCONDITION[&] { return oldCounted.captured(); };
+    }
+
+    void copyTemporary() {
+      OLD(oldCounted, CountedCopies());
+      POSTCONDITION[&] { return oldCounted.captured(); };
+    }
+
+    std::size_t size() const {
+      ++sizeCalled;
+      return values.size();
+    }
+
+    std::vector<int> values;
+    CountedCopies counted;
+    mutable int sizeCalled;
+  };
+
+  int postConditionFailed = 0;
+  void countingPostConditionHandler(const char*, int) {
+    ++postConditionFailed;
+  }
+
+  class ContractOldTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override {
+      postConditionFailed = 0;
+      CountedCopies::copies = 0;
+      contract_light::setHandlerFailedPostCondition(&countingPostConditionHandler);
+    }
+
+    void TearDown() override {
+      contract_light::setSampleRate(1);
+    }
+  };
+}
+
+TEST_F(ContractOldTest, ThatTheOldValueIsTakenAtTheEntryOfTheFunction)
+{
+  Stack sut;
+  sut.push(1);
+  sut.push(2);
+  EXPECT_EQ(0, postConditionFailed);
+  EXPECT_EQ(2, sut.sizeCalled);
+
+  sut.pushTwice(3);
+  EXPECT_EQ(1, postConditionFailed);
+}
+
+TEST_F(ContractOldTest, ThatAnOldContainerIsACopy)
+{
+  Stack sut;
+  sut.push(1);
+  sut.append({ 2, 3 });
+  EXPECT_EQ(0, postConditionFailed);
+  EXPECT_EQ(3u, sut.values.size());
+}
+
+TEST_F(ContractOldTest, ThatNestedPostconditionsCaptureOnlyTheirOwnOldValues)
+{
+  Stack sut;
+  sut.pushAll({ 1, 2, 3 });
+  EXPECT_EQ(0, postConditionFailed);
+  EXPECT_EQ(4, sut.sizeCalled);
+}
+
+TEST_F(ContractOldTest, ThatATemporaryIsNotCopied)
+{
+  Stack sut;
+  sut.copyTemporary();
+  EXPECT_EQ(0, CountedCopies::copies);
+  sut.copyMember();
+  EXPECT_EQ(1, CountedCopies::copies);
+  EXPECT_EQ(0, postConditionFailed);
+}
+
+TEST_F(ContractOldTest, ThatTheOldValueIsOnlyTakenForSampledCalls)
+{
+  contract_light::setSampleRate(10);
+  Stack sut;
+  for (int i = 0; i < 100; ++i) {
+    sut.push(i);
+  }
+  EXPECT_EQ(10, sut.sizeCalled);
+  EXPECT_EQ(0, postConditionFailed);
+}
+
+#ifdef CONTRACT_LIGHT_REGISTERS_SITES
+TEST_F(ContractOldTest, ThatANestedPostconditionDoesNotCaptureTheOldValuesOfAnUnsampledOne)
+{
+  Stack sut;
+  sut.pushAll({});
+  std::uint64_t pushAllId = 0;
+  for (auto site : contract_light::contractSites()) {
+    if (site->kind == contract_light::ContractKind::PostCondition && std::strcmp(site->function, "pushAll") == 0) {
+      pushAllId = site->id;
+    }
+  }
+  ASSERT_NE(0u, pushAllId);
+  contract_light::setSiteSampleRate(pushAllId, 1000000);
+  // The countdown of the site still samples the next call
+  sut.pushAll({});
+  sut.sizeCalled = 0;
+
+  sut.pushAll({ 1, 2, 3 });
+  EXPECT_EQ(3, sut.sizeCalled);
+  EXPECT_EQ(0, postConditionFailed);
+  contract_light::resetSiteSampleRate(pushAllId);
+}
+#endif
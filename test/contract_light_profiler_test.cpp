@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#define CONTRACT_LIGHT_PROFILING
+#define CONTRACT_LIGHT_COUNTERS
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+  class ProfiledClass
+  {
+  public:
+    ProfiledClass() : values(1000, 1) {}
+
+    void cheap(int x) {
+      PRECONDITION[&] { return x >= 0; };
+    }
+
+    void expensive(int x) {
+      PRECONDITION[&, this] {
+        volatile int sum = 0;
+        for (auto v : values) {
+          sum = sum + v;
+        }
+        return sum > x;
+      };
+    }
+
+    std::vector<int> values;
+  };
+
+  std::vector<contract_light::SiteCost> sitesOfThisFile(contract_light::CostOrder order) {
+    std::vector<contract_light::SiteCost> result;
+    for (const auto& c : contract_light::mostExpensiveSites(1000, order)) {
+      if (std::strstr(c.site->fileName, "contract_light_profiler_test") != nullptr) {
+        result.push_back(c);
+      }
+    }
+    return result;
+  }
+}
+
+TEST(ContractProfilerTest, ThatTheMostExpensiveSiteIsReportedFirst)
+{
+  ProfiledClass sut;
+  for (int i = 0; i < 100; ++i) {
+    sut.cheap(i);
+    sut.expensive(i);
+  }
+
+  for (auto order : { contract_light::CostOrder::Total, contract_light::CostOrder::P99 }) {
+    const auto sites = sitesOfThisFile(order);
+    ASSERT_EQ(2u, sites.size());
+    EXPECT_GT(sites[0].site->line, sites[1].site->line);
+    EXPECT_GE(sites[0].totalTicks, sites[1].totalTicks);
+    EXPECT_GE(sites[0].p99Ticks, sites[1].p99Ticks);
+    EXPECT_GE(sites[0].evaluations, 100u);
+  }
+}
+
+TEST(ContractProfilerTest, ThatTheReportIsLimitedToN)
+{
+  ProfiledClass sut;
+  sut.cheap(1);
+  sut.expensive(1);
+  EXPECT_EQ(1u, contract_light::mostExpensiveSites(1).size());
+}
+
+TEST(ContractProfilerTest, ThatProfilingAndCountingCanBeCombined)
+{
+  std::uint64_t before = 0;
+  for (const auto& s : contract_light::snapshot()) {
+    if (std::strstr(s.site->fileName, "contract_light_profiler_test") != nullptr) {
+      before += s.evaluations;
+    }
+  }
+
+  ProfiledClass sut;
+  sut.cheap(1);
+  sut.expensive(1);
+
+  std::uint64_t after = 0;
+  for (const auto& s : contract_light::snapshot()) {
+    if (std::strstr(s.site->fileName, "contract_light_profiler_test") != nullptr) {
+      after += s.evaluations;
+    }
+  }
+  EXPECT_EQ(2u, after - before);
+}
@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+  struct CountedResult
+  {
+    static int copies;
+    static int moves;
+
+    explicit CountedResult(int v) : value(v) {}
+    CountedResult(const CountedResult& other) : value(other.value) { ++copies; }
+    CountedResult(CountedResult&& other) : value(other.value) { ++moves; }
+
+    int value;
+  };
+
+  int CountedResult::copies = 0;
+  int CountedResult::moves = 0;
+
+  class Factory
+  {
+  public:
+    Factory() : invariantCalled(0) {}
+
+    std::vector<int> make(std::size_t n) {
+      POSTCONDITION_RESULT[&](const std::vector<int>& result) { return result.size() == n; };
+      RETURN_CHECKED(std::vector<int>(n, 42));
+    }
+
+    std::vector<int> makeWrong(std::size_t n) {
+      POSTCONDITION_RESULT[&](const std::vector<int>& result) { return result.size() == n; };
+      RETURN_CHECKED(std::vector<int>(n + 1, 42));
+    }
+
+    std::string name(bool longName) {
+      POSTCONDITION_RESULT[](const std::string& result) { return !result.empty(); };
+      if (longName) {
+        RETURN_CHECKED(std::string("a long name that does not fit into the small buffer"));
+      }
+      RETURN_CHECKED(std::string("short"));
+    }
+
+    CountedResult counted(int v) {
+      POSTCONDITION_RESULT[&](const CountedResult& result) { return result.value == v; };
+      RETURN_CHECKED(CountedResult(v));
+    }
+
+    std::unique_ptr<int> owned(int v) {
+      POSTCONDITION_RESULT[&](const std::unique_ptr<int>& result) { return result && *result == v; };
+      RETURN_CHECKED(std::unique_ptr<int>(new int(v)));
+    }
+
+    CountedResult countedLocal(int v, int offset) {
+      POSTCONDITION_RESULT[&](const CountedResult& result) { return result.value == v; };
+      CountedResult local(v);
+      local.value += offset;
+      RETURN_CHECKED_LOCAL(local);
+    }
+
+    std::unique_ptr<int> ownedLocal(int v) {
+      POSTCONDITION_RESULT[&](const std::unique_ptr<int>& result) { return result && *result == v; };
+      std::unique_ptr<int> local(new int(0));
+      *local = v;
+      RETURN_CHECKED_LOCAL(local);
+    }
+
+    CountedResult countedMember() {
+      POSTCONDITION_RESULT[&](const CountedResult& result) { return result.value == _member.value; };
+      RETURN_CHECKED(_member);
+    }
+
+    bool invariant() const {
+      ++invariantCalled;
+      return true;
+    }
+
+    mutable int invariantCalled;
+
+  private:
+    CountedResult _member = CountedResult(3);
+
+    CONTRACTOR
+  };
+
+  int postConditionFailed = 0;
+  void countingPostConditionHandler(const char*, int) {
+    ++postConditionFailed;
+  }
+
+  class ContractResultTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override {
+      postConditionFailed = 0;
+      CountedResult::copies = 0;
+      CountedResult::moves = 0;
+      contract_light::setHandlerFailedPostCondition(&countingPostConditionHandler);
+    }
+  };
+}
+
+TEST_F(ContractResultTest, ThatAFulfilledResultConditionDoesNotFire)
+{
+  Factory sut;
+  EXPECT_EQ(10u, sut.make(10).size());
+  EXPECT_EQ(0, postConditionFailed);
+  EXPECT_EQ(1, sut.invariantCalled);
+}
+
+TEST_F(ContractResultTest, ThatAFailingResultConditionFiresAndTheResultIsStillReturned)
+{
+  Factory sut;
+  EXPECT_EQ(11u, sut.makeWrong(10).size());
+  EXPECT_EQ(1, postConditionFailed);
+}
+
+TEST_F(ContractResultTest, ThatEveryReturnPathIsChecked)
+{
+  Factory sut;
+  EXPECT_EQ("short", sut.name(false));
+  EXPECT_EQ(std::string::npos, sut.name(true).find("short"));
+  EXPECT_EQ(0, postConditionFailed);
+  EXPECT_EQ(2, sut.invariantCalled);
+}
+
+TEST_F(ContractResultTest, ThatTheResultIsNotCopied)
+{
+  Factory sut;
+  const auto result = sut.counted(7);
+  EXPECT_EQ(7, result.value);
+  EXPECT_EQ(0, CountedResult::copies);
+#if defined(__GNUC__)
+  // GCC and Clang elide all moves, even without optimization
+  EXPECT_EQ(0, CountedResult::moves);
+#endif
+  EXPECT_EQ(0, postConditionFailed);
+}
+
+TEST_F(ContractResultTest, ThatAMoveOnlyResultIsChecked)
+{
+  Factory sut;
+  auto result = sut.owned(5);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(5, *result);
+  EXPECT_EQ(0, postConditionFailed);
+}
+
+TEST_F(ContractResultTest, ThatANamedLocalIsNotCopied)
+{
+  Factory sut;
+  const auto result = sut.countedLocal(7, 0);
+  EXPECT_EQ(7, result.value);
+  EXPECT_EQ(0, CountedResult::copies);
+#if defined(__GNUC__)
+  // As for a plain return of the local
+  EXPECT_EQ(0, CountedResult::moves);
+#endif
+  EXPECT_EQ(0, postConditionFailed);
+  EXPECT_EQ(1, sut.invariantCalled);
+}
+
+TEST_F(ContractResultTest, ThatAFailingNamedLocalFiresAndIsStillReturned)
+{
+  Factory sut;
+  EXPECT_EQ(8, sut.countedLocal(7, 1).value);
+  EXPECT_EQ(1, postConditionFailed);
+}
+
+TEST_F(ContractResultTest, ThatAMoveOnlyNamedLocalIsChecked)
+{
+  Factory sut;
+  auto result = sut.ownedLocal(5);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(5, *result);
+  EXPECT_EQ(0, postConditionFailed);
+}
+
+TEST_F(ContractResultTest, ThatAnLvalueIsCopiedOnceAsByAPlainReturn)
+{
+  Factory sut;
+  EXPECT_EQ(3, sut.countedMember().value);
+  EXPECT_EQ(1, CountedResult::copies);
+  EXPECT_EQ(0, postConditionFailed);
+}
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#define CONTRACT_LIGHT_SAMPLING
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <cstring>
+
+namespace
+{
+  class SampledClass
+  {
+  public:
+    SampledClass() : preCalled(0), postCalled(0), invariantCalled(0) {}
+
+    void pre() {
+      PRECONDITION[this] { ++preCalled; return true; };
+    }
+
+    void post() {
+      POSTCONDITION[this] { ++postCalled; return true; };
+    }
+
+    bool invariant() const {
+      ++invariantCalled;
+      return true;
+    }
+
+    int preCalled;
+    int postCalled;
+    mutable int invariantCalled;
+
+    CONTRACTOR
+  };
+
+  std::uint64_t siteIdOf(contract_light::ContractKind kind) {
+    for (auto s : contract_light::contractSites()) {
+      if (s->kind == kind && std::strstr(s->fileName, "contract_light_sampling_test") != nullptr) {
+        return s->id;
+      }
+    }
+    return 0;
+  }
+
+  class ContractSamplingTest : public ::testing::Test
+  {
+  protected:
+    void TearDown() override {
+      contract_light::setSampleRate(1);
+      contract_light::resetSiteSampleRate(siteIdOf(contract_light::ContractKind::PreCondition));
+      contract_light::resetSiteSampleRate(siteIdOf(contract_light::ContractKind::PostCondition));
+    }
+  };
+}
+
+TEST_F(ContractSamplingTest, ThatEveryCallIsCheckedByDefault)
+{
+  SampledClass sut;
+  for (int i = 0; i < 100; ++i) {
+    sut.pre();
+  }
+  EXPECT_EQ(100, sut.preCalled);
+  EXPECT_EQ(100, sut.invariantCalled);
+}
+
+TEST_F(ContractSamplingTest, ThatOnlyEveryNthCallIsCheckedWithACountdown)
+{
+  contract_light::setSampleRate(10);
+  SampledClass sut;
+  for (int i = 0; i < 1000; ++i) {
+    sut.pre();
+    sut.post();
+  }
+  EXPECT_EQ(100, sut.preCalled);
+  EXPECT_EQ(100, sut.postCalled);
+  // The invariant is only checked on sampled calls
+  EXPECT_EQ(200, sut.invariantCalled);
+}
+
+TEST_F(ContractSamplingTest, ThatAboutOneOfNCallsIsCheckedRandomly)
+{
+  contract_light::setSampleRate(10, contract_light::SamplingMode::Random);
+  SampledClass sut;
+  for (int i = 0; i < 100000; ++i) {
+    sut.pre();
+  }
+  EXPECT_GT(sut.preCalled, 9000);
+  EXPECT_LT(sut.preCalled, 11000);
+}
+
+#ifdef CONTRACT_LIGHT_REGISTERS_SITES
+TEST_F(ContractSamplingTest, ThatASiteRateOverridesTheGlobalRate)
+{
+  contract_light::setSampleRate(1000);
+  contract_light::setSiteSampleRate(siteIdOf(contract_light::ContractKind::PreCondition), 2);
+  SampledClass sut;
+  for (int i = 0; i < 100; ++i) {
+    sut.pre();
+    sut.post();
+  }
+  EXPECT_EQ(50, sut.preCalled);
+  EXPECT_EQ(1, sut.postCalled);
+
+  contract_light::resetSiteSampleRate(siteIdOf(contract_light::ContractKind::PreCondition));
+  contract_light::setSampleRate(1);
+  sut.preCalled = 0;
+  sut.pre();
+  EXPECT_EQ(1, sut.preCalled);
+}
+#endif
+
+TEST_F(ContractSamplingTest, ThatALowerRateTakesEffectImmediately)
+{
+  contract_light::setSampleRate(1000);
+  SampledClass sut;
+  sut.pre();
+  sut.pre();
+  EXPECT_EQ(1, sut.preCalled);
+
+  contract_light::setSampleRate(1);
+  sut.pre();
+  EXPECT_EQ(2, sut.preCalled);
+}
@@ -0,0 +1,38 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#ifndef CONTRACT_LIGHT_SITE_SHARED_HPP
+#define CONTRACT_LIGHT_SITE_SHARED_HPP
+
+#include "contract_light.hpp"
+
+namespace site_shared
+{
+  /**
+   * Its inline member function is compiled in two translation units, so both
+   * refer to its contract sites. The pre- and postcondition share one line.
+   */
+  class Shared
+  {
+  public:
+    Shared() : calls(0) {}
+
+    void call() {
+      PRECONDITION[this] { return calls >= 0; }; POSTCONDITION[this] { return calls > 0; };
+      ++calls;
+    }
+
+    int calls;
+  };
+
+  void callInOtherUnit(Shared& shared);
+}
+
+#endif
@@ -0,0 +1,18 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include "contract_light_site_shared.hpp"
+
+namespace site_shared
+{
+  void callInOtherUnit(Shared& shared) {
+    shared.call();
+  }
+}
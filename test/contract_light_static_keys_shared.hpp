@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#ifndef CONTRACT_LIGHT_STATIC_KEYS_SHARED_HPP
+#define CONTRACT_LIGHT_STATIC_KEYS_SHARED_HPP
+
+#define CONTRACT_LIGHT_LEVEL CONTRACT_LIGHT_LEVEL_AUDIT
+#define CONTRACT_LIGHT_STATIC_KEYS
+
+#include "contract_light.hpp"
+
+#if defined(__GNUC__)
+#define STATIC_KEYS_NOINLINE __attribute__((noinline))
+#else
+#define STATIC_KEYS_NOINLINE
+#endif
+
+namespace static_keys
+{
+  /**
+   * Its inline member function is emitted out of line in both translation
+   * units of the static key tests, so the linker discards one of the copies
+   * together with its patch point.
+   */
+  class Shared
+  {
+  public:
+    Shared() : preCalled(0) {}
+
+    STATIC_KEYS_NOINLINE void pre() {
+      PRECONDITION[this] { ++preCalled; return true; };
+    }
+
+    int preCalled;
+  };
+
+  void preInOtherUnit(Shared& shared);
+}
+
+#endif
@@ -0,0 +1,18 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include "contract_light_static_keys_shared.hpp"
+
+namespace static_keys
+{
+  void preInOtherUnit(Shared& shared) {
+    shared.pre();
+  }
+}
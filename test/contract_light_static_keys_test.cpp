@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "contract_light_static_keys_shared.hpp"
+
+namespace
+{
+  class PatchedClass
+  {
+  public:
+    PatchedClass() : preCalled(0), auditCalled(0), invariantCalled(0) {}
+
+    void pre() {
+      PRECONDITION[this] { ++preCalled; return true; };
+      PRECONDITION_AUDIT[this] { ++auditCalled; return true; };
+    }
+
+    bool invariant() const {
+      ++invariantCalled;
+      return true;
+    }
+
+    int preCalled;
+    int auditCalled;
+    mutable int invariantCalled;
+
+    CONTRACTOR
+  };
+
+  namespace patched
+  {
+    CONTRACT_MODULE("patched");
+
+    class Buffer
+    {
+    public:
+      Buffer() : preCalled(0) {}
+
+      void pre() {
+        PRECONDITION[this] { ++preCalled; return true; };
+      }
+
+      int preCalled;
+    };
+  }
+
+  class ContractStaticKeysTest : public ::testing::Test
+  {
+  protected:
+    void TearDown() override {
+      contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_AUDIT);
+      contract_light::resetModuleContractLevel("patched");
+      contract_light::resetClassContractLevel<PatchedClass>();
+    }
+  };
+}
+
+TEST_F(ContractStaticKeysTest, ThatEveryCompiledContractIsCheckedByDefault)
+{
+  PatchedClass sut;
+  sut.pre();
+  EXPECT_EQ(1, sut.preCalled);
+  EXPECT_EQ(1, sut.auditCalled);
+  EXPECT_EQ(1, sut.invariantCalled);
+}
+
+TEST_F(ContractStaticKeysTest, ThatSwitchedOffSitesAreSkipped)
+{
+  PatchedClass sut;
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_DEFAULT);
+  sut.pre();
+  EXPECT_EQ(1, sut.preCalled);
+  EXPECT_EQ(0, sut.auditCalled);
+
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_OFF);
+  sut.pre();
+  EXPECT_EQ(1, sut.preCalled);
+  EXPECT_EQ(0, sut.auditCalled);
+  EXPECT_EQ(1, sut.invariantCalled);
+
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_AUDIT);
+  sut.pre();
+  EXPECT_EQ(2, sut.preCalled);
+  EXPECT_EQ(1, sut.auditCalled);
+}
+
+TEST_F(ContractStaticKeysTest, ThatModuleAndClassLevelsOverrideTheGlobalLevel)
+{
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_OFF);
+  contract_light::setModuleContractLevel("patched", CONTRACT_LIGHT_LEVEL_DEFAULT);
+  contract_light::setClassContractLevel<PatchedClass>(CONTRACT_LIGHT_LEVEL_AUDIT);
+  PatchedClass sut;
+  patched::Buffer buffer;
+  sut.pre();
+  buffer.pre();
+  EXPECT_EQ(1, sut.preCalled);
+  EXPECT_EQ(1, sut.auditCalled);
+  EXPECT_EQ(1, buffer.preCalled);
+}
+
+TEST_F(ContractStaticKeysTest, ThatAnInlineFunctionOfTwoUnitsIsSwitched)
+{
+  static_keys::Shared sut;
+  sut.pre();
+  static_keys::preInOtherUnit(sut);
+  EXPECT_EQ(2, sut.preCalled);
+
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_OFF);
+  sut.pre();
+  static_keys::preInOtherUnit(sut);
+  EXPECT_EQ(2, sut.preCalled);
+
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_AUDIT);
+  sut.pre();
+  EXPECT_EQ(3, sut.preCalled);
+}
+
+#ifdef CONTRACT_LIGHT_USES_STATIC_KEYS
+TEST_F(ContractStaticKeysTest, ThatThePatchPointsAreRewritten)
+{
+  const auto initial = contract_light::staticKeyStatus();
+  EXPECT_LE(3u, initial.points);
+  EXPECT_EQ(initial.points, initial.enabled);
+  EXPECT_EQ(0u, initial.failures);
+
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_OFF);
+  const auto off = contract_light::staticKeyStatus();
+  EXPECT_EQ(0u, off.enabled);
+  EXPECT_EQ(0u, off.failures);
+
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_AUDIT);
+  EXPECT_EQ(initial.points, contract_light::staticKeyStatus().enabled);
+}
+#endif
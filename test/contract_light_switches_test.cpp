@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#define CONTRACT_LIGHT_LEVEL CONTRACT_LIGHT_LEVEL_AUDIT
+#define CONTRACT_LIGHT_RUNTIME_LEVELS
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <cstring>
+
+namespace
+{
+#define SWITCHED_CLASS(Name)                                                  \
+  class Name                                                                  \
+  {                                                                           \
+  public:                                                                     \
+    Name() : preCalled(0), auditCalled(0), invariantCalled(0) {}              \
+                                                                              \
+    void pre() {                                                              \
+      PRECONDITION[this] { ++preCalled; return true; };                       \
+      PRECONDITION_AUDIT[this] { ++auditCalled; return true; };               \
+    }                                                                         \
+                                                                              \
+    bool invariant() const {                                                  \
+      ++invariantCalled;                                                      \
+      return true;                                                            \
+    }                                                                         \
+                                                                              \
+    int preCalled;                                                            \
+    int auditCalled;                                                          \
+    mutable int invariantCalled;                                              \
+                                                                              \
+    CONTRACTOR                                                                \
+  }
+
+  SWITCHED_CLASS(Unassigned);
+
+  namespace storage
+  {
+    CONTRACT_MODULE("storage");
+
+    SWITCHED_CLASS(Table);
+    SWITCHED_CLASS(Index);
+  }
+
+  class Nested
+  {
+  public:
+    Nested() : invariantCalled(0), stackEmptyInBody(false) {}
+
+    void set() {
+      PRECONDITION[this] { return true; };
+      stackEmptyInBody = contract_light_contractor().stackEmpty();
+    }
+
+    bool invariant() const {
+      ++invariantCalled;
+      return true;
+    }
+
+    mutable int invariantCalled;
+    bool stackEmptyInBody;
+
+    CONTRACTOR_PER_OBJECT
+  };
+
+  class ContractSwitchesTest : public ::testing::Test
+  {
+  protected:
+    void TearDown() override {
+      contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_AUDIT);
+      contract_light::resetModuleContractLevel("storage");
+      contract_light::resetClassContractLevel<storage::Index>();
+      contract_light::resetClassContractLevel<Nested>();
+    }
+  };
+}
+
+TEST_F(ContractSwitchesTest, ThatEveryCompiledContractIsCheckedByDefault)
+{
+  Unassigned sut;
+  sut.pre();
+  EXPECT_EQ(1, sut.preCalled);
+  EXPECT_EQ(1, sut.auditCalled);
+  EXPECT_EQ(1, sut.invariantCalled);
+}
+
+TEST_F(ContractSwitchesTest, ThatTheGlobalDefaultLevelSkipsTheAuditContracts)
+{
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_DEFAULT);
+  Unassigned sut;
+  sut.pre();
+  EXPECT_EQ(1, sut.preCalled);
+  EXPECT_EQ(0, sut.auditCalled);
+  EXPECT_EQ(1, sut.invariantCalled);
+}
+
+TEST_F(ContractSwitchesTest, ThatTheGlobalOffLevelSkipsAllContracts)
+{
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_OFF);
+  Unassigned sut;
+  sut.pre();
+  EXPECT_EQ(0, sut.preCalled);
+  EXPECT_EQ(0, sut.auditCalled);
+  EXPECT_EQ(0, sut.invariantCalled);
+}
+
+TEST_F(ContractSwitchesTest, ThatAModuleLevelOverridesTheGlobalLevel)
+{
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_DEFAULT);
+  contract_light::setModuleContractLevel("storage", CONTRACT_LIGHT_LEVEL_AUDIT);
+  Unassigned unassigned;
+  storage::Table table;
+  unassigned.pre();
+  table.pre();
+  EXPECT_EQ(0, unassigned.auditCalled);
+  EXPECT_EQ(1, table.auditCalled);
+}
+
+TEST_F(ContractSwitchesTest, ThatAClassLevelOverridesTheModuleLevel)
+{
+  contract_light::setModuleContractLevel("storage", CONTRACT_LIGHT_LEVEL_AUDIT);
+  contract_light::setClassContractLevel<storage::Index>(CONTRACT_LIGHT_LEVEL_OFF);
+  storage::Table table;
+  storage::Index index;
+  table.pre();
+  index.pre();
+  EXPECT_EQ(1, table.preCalled);
+  EXPECT_EQ(0, index.preCalled);
+  EXPECT_EQ(0, index.invariantCalled);
+
+  contract_light::resetClassContractLevel<storage::Index>();
+  index.pre();
+  EXPECT_EQ(1, index.preCalled);
+}
+
+TEST_F(ContractSwitchesTest, ThatASwitchedOffSiteDoesNotTouchTheInvariant)
+{
+  Nested sut;
+  sut.set();
+  EXPECT_FALSE(sut.stackEmptyInBody);
+  EXPECT_EQ(1, sut.invariantCalled);
+
+  contract_light::setClassContractLevel<Nested>(CONTRACT_LIGHT_LEVEL_OFF);
+  sut.set();
+  EXPECT_TRUE(sut.stackEmptyInBody);
+  EXPECT_EQ(1, sut.invariantCalled);
+}
+
+TEST_F(ContractSwitchesTest, ThatALevelChangeTakesEffectImmediately)
+{
+  Unassigned sut;
+  sut.pre();
+  EXPECT_EQ(1, sut.auditCalled);
+
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_DEFAULT);
+  sut.pre();
+  EXPECT_EQ(1, sut.auditCalled);
+
+  contract_light::setContractLevel(CONTRACT_LIGHT_LEVEL_AUDIT);
+  sut.pre();
+  EXPECT_EQ(2, sut.auditCalled);
+}
+
+#ifdef CONTRACT_LIGHT_REGISTERS_SITES
+TEST_F(ContractSwitchesTest, ThatASiteLevelOverridesTheClassLevel)
+{
+  std::uint64_t auditSite = 0;
+  for (auto s : contract_light::contractSites()) {
+    if (s->level == CONTRACT_LIGHT_LEVEL_AUDIT && std::strstr(s->fileName, "contract_light_switches_test") != nullptr) {
+      auditSite = s->id;
+    }
+  }
+  ASSERT_NE(0u, auditSite);
+
+  contract_light::setClassContractLevel<storage::Index>(CONTRACT_LIGHT_LEVEL_DEFAULT);
+  contract_light::setSiteContractLevel(auditSite, CONTRACT_LIGHT_LEVEL_AUDIT);
+  storage::Index index;
+  index.pre();
+  EXPECT_EQ(1, index.auditCalled);
+
+  contract_light::resetSiteContractLevel(auditSite);
+  index.pre();
+  EXPECT_EQ(1, index.auditCalled);
+}
+#endif
@@ -10,6 +10,13 @@
 
 #include <gtest/gtest.h>
 #include "contract_light.hpp"
+#include "contract_light_site_shared.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
 
 namespace
 {
@@ -272,4 +279,118 @@ TEST(ContractInvariantTest, ThatMultipleConditionsAndInvariantsResultOnlyInASing
   sut.dummy1();
   EXPECT_EQ(1, sut.invariantCalled);
 
-}
\ No newline at end of file
+}
+namespace
+{
+  class TestClassWithAuditContracts
+  {
+  public:
+    TestClassWithAuditContracts()
+      : preConditionCalled(0)
+      , auditPreConditionCalled(0)
+      , auditPostConditionCalled(0)
+    {}
+
+    void dummy() {
+      PRECONDITION[this] { ++preConditionCalled; return true; };
+      PRECONDITION_AUDIT[this] { ++auditPreConditionCalled; return false; };
+      POSTCONDITION_AUDIT[this] { ++auditPostConditionCalled; return false; };
+    }
+
+    int preConditionCalled;
+    int auditPreConditionCalled;
+    int auditPostConditionCalled;
+  };
+}
+
+TEST(ContractLevelTest, ThatAuditConditionsAreNotEvaluatedOnTheDefaultLevel)
+{
+  TestClassWithAuditContracts sut;
+  EXPECT_NO_THROW(sut.dummy());
+  EXPECT_EQ(1, sut.preConditionCalled);
+  EXPECT_EQ(0, sut.auditPreConditionCalled);
+  EXPECT_EQ(0, sut.auditPostConditionCalled);
+}
+
+#ifdef CONTRACT_LIGHT_REGISTERS_SITES
+TEST(ContractSiteTest, ThatEveryContractOfAFunctionIsRegisteredOnce)
+{
+  int preConditions = 0, postConditions = 0, invariants = 0;
+  for (auto site : contract_light::contractSites()) {
+    if (std::string(site->function) != "dummy1") {
+      continue;
+    }
+    EXPECT_NE(nullptr, std::strstr(site->fileName, "contract_light_test.cpp"));
+    EXPECT_EQ(CONTRACT_LIGHT_LEVEL_DEFAULT, site->level);
+    switch (site->kind) {
+    case contract_light::ContractKind::PreCondition: ++preConditions; break;
+    case contract_light::ContractKind::PostCondition: ++postConditions; break;
+    case contract_light::ContractKind::Invariant:
+      ++invariants;
+      EXPECT_STREQ("invariant()", site->expression);
+      break;
+    case contract_light::ContractKind::Deferred:
+      ADD_FAILURE() << "dummy1 has no deferred checks";
+      break;
+    }
+  }
+  EXPECT_EQ(2, preConditions);
+  EXPECT_EQ(2, postConditions);
+  EXPECT_EQ(2, invariants);
+}
+
+TEST(ContractSiteTest, ThatASiteOfAnInlineFunctionIsListedOnceForAllTranslationUnits)
+{
+  site_shared::Shared sut;
+  sut.call();
+  site_shared::callInOtherUnit(sut);
+  EXPECT_EQ(2, sut.calls);
+
+  std::vector<const contract_light::ContractSite*> sites;
+  for (auto site : contract_light::contractSites()) {
+    if (std::strstr(site->fileName, "contract_light_site_shared.hpp") != nullptr) {
+      sites.push_back(site);
+    }
+  }
+  ASSERT_EQ(2u, sites.size());
+  EXPECT_EQ(sites[0]->line, sites[1]->line);
+  EXPECT_NE(sites[0]->kind, sites[1]->kind);
+  EXPECT_NE(sites[0]->id, sites[1]->id);
+}
+
+TEST(ContractSiteTest, ThatOnlyTheInstantiationsOfOneSiteShareItsId)
+{
+  auto sites = contract_light::contractSites();
+  std::sort(sites.begin(), sites.end(), [](const contract_light::ContractSite* l, const contract_light::ContractSite* r) {
+    return l->id < r->id;
+  });
+  for (std::size_t i = 1; i < sites.size(); ++i) {
+    if (sites[i - 1]->id == sites[i]->id) {
+      EXPECT_STREQ(sites[i - 1]->fileName, sites[i]->fileName);
+      EXPECT_EQ(sites[i - 1]->line, sites[i]->line);
+      EXPECT_EQ(sites[i - 1]->kind, sites[i]->kind);
+      EXPECT_EQ(sites[i - 1]->level, sites[i]->level);
+    }
+  }
+}
+
+TEST(ContractSiteTest, ThatDisabledContractsAreNotRegistered)
+{
+  for (auto site : contract_light::contractSites()) {
+    EXPECT_EQ(nullptr, std::strstr(site->fileName, "contract_light_level_test.cpp"));
+  }
+}
+#endif
+
+TEST(ContractGuardSizeTest, ThatGuardsOnlyKeepTheSiteAndIfNeededTheProvider)
+{
+  using namespace contract_light::contract_detail;
+  int x = 0;
+  auto op = [&x] { return x == 0; };
+  using Op = decltype(op);
+
+  EXPECT_EQ(sizeof(void*), (sizeof(PreCondition<PreConditionContext<TestClassWithOutInvariant>, Op>)));
+  EXPECT_EQ(2 * sizeof(void*), (sizeof(PreCondition<PreConditionContext<TestClassWithInvariant>, Op>)));
+  EXPECT_EQ(sizeof(void*) + sizeof(Op), (sizeof(PostCondition<PostConditionContext<TestClassWithOutInvariant>, Op>)));
+  EXPECT_EQ(2 * sizeof(void*), (sizeof(Invariant<ContractContext<TestClassWithInvariant>>)));
+}
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <thread>
+
+namespace
+{
+  struct Plain
+  {
+    int x;
+    mutable int invariantCalled;
+  };
+
+  class TestClassWithThreadLocalContractor
+  {
+  public:
+    int x;
+    mutable int invariantCalled;
+
+    TestClassWithThreadLocalContractor()
+      : x(0)
+      , invariantCalled(0)
+    {}
+
+    void setX(int newX) {
+      PRECONDITION[&] { return newX >= 0; };
+      POSTCONDITION[&, this] { return x == newX; };
+      x = newX;
+    }
+
+    void setTwice(int newX) {
+      PRECONDITION[&] { return newX >= 0; };
+      setX(newX);
+      setX(newX);
+    }
+
+    int getX() const {
+      PRECONDITION[] { return true; };
+      return x;
+    }
+
+    template <typename Other>
+    void callOther(Other& other) {
+      INVARIANT;
+      other.callBack(*this);
+    }
+
+    bool invariant() const {
+      ++invariantCalled;
+      return x >= 0;
+    }
+
+    CONTRACTOR_THREAD_LOCAL
+  };
+
+  class CallBackClass
+  {
+  public:
+    mutable int invariantCalled;
+
+    CallBackClass() : invariantCalled(0) {}
+
+    void callBack(TestClassWithThreadLocalContractor& caller) {
+      INVARIANT;
+      caller.setX(1);
+    }
+
+    bool invariant() const {
+      ++invariantCalled;
+      return true;
+    }
+
+    CONTRACTOR_THREAD_LOCAL
+  };
+}
+
+TEST(ThreadLocalContractorTest, ThatTheContractorTakesNoSpaceInTheObject)
+{
+  EXPECT_EQ(sizeof(Plain), sizeof(TestClassWithThreadLocalContractor));
+}
+
+TEST(ThreadLocalContractorTest, ThatNestedCallsOnTheSameObjectCheckTheInvariantOnlyOnce)
+{
+  TestClassWithThreadLocalContractor sut;
+  sut.setTwice(2);
+  EXPECT_EQ(1, sut.invariantCalled);
+  EXPECT_EQ(0, contract_light::contract_detail::invariantStack().size);
+}
+
+TEST(ThreadLocalContractorTest, ThatAConstMemberFunctionChecksTheInvariant)
+{
+  const TestClassWithThreadLocalContractor sut;
+  EXPECT_EQ(0, sut.getX());
+  EXPECT_EQ(1, sut.invariantCalled);
+}
+
+TEST(ThreadLocalContractorTest, ThatAReentrantCallbackDoesNotCheckTheInvariantOfTheActiveObject)
+{
+  TestClassWithThreadLocalContractor sut;
+  CallBackClass other;
+  sut.callOther(other);
+  EXPECT_EQ(1, sut.invariantCalled);
+  EXPECT_EQ(1, other.invariantCalled);
+}
+
+TEST(ThreadLocalContractorTest, ThatTheNestingIsTrackedPerThread)
+{
+  TestClassWithThreadLocalContractor sut;
+  contract_light::ThreadLocalContract::pushInvariantOnStack(&sut);
+
+  std::thread t([&] { sut.getX(); });
+  t.join();
+  EXPECT_EQ(1, sut.invariantCalled);
+
+  sut.getX();
+  EXPECT_EQ(1, sut.invariantCalled);
+  EXPECT_TRUE(contract_light::ThreadLocalContract::popInvariantFromStack(&sut));
+}
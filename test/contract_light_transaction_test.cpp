@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////
+//
+// Copyright 2014 Felix Petriconi
+//
+// License: http://boost.org/LICENSE_1_0.txt, Boost License 1.0
+//
+// Authors: http://petriconi.net, Felix Petriconi
+//
+//////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "contract_light.hpp"
+
+#include <vector>
+
+namespace
+{
+  // The same container with the per object and the thread local contractor
+#define BULK_CONTAINER(Name, Contractor)                                      \
+  class Name                                                                  \
+  {                                                                           \
+  public:                                                                     \
+    Name() : invariantCalled(0), broken(false) {}                             \
+                                                                              \
+    void insert(int v) {                                                      \
+      PRECONDITION[&] { return v >= 0; };                                     \
+      POSTCONDITION[this] { return !values.empty(); };                        \
+      values.push_back(v);                                                    \
+    }                                                                         \
+                                                                              \
+    void loadAll(const std::vector<int>& all) {                               \
+      CONTRACT_TRANSACTION(*this);                                            \
+      for (auto v : all) {                                                    \
+        insert(v);                                                            \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    bool invariant() const {                                                  \
+      ++invariantCalled;                                                      \
+      return !broken;                                                         \
+    }                                                                         \
+                                                                              \
+    std::vector<int> values;                                                  \
+    mutable int invariantCalled;                                              \
+    bool broken;                                                              \
+                                                                              \
+    Contractor                                                                \
+  }
+
+  BULK_CONTAINER(BulkContainer, CONTRACTOR);
+  BULK_CONTAINER(ThreadLocalBulkContainer, CONTRACTOR_THREAD_LOCAL);
+
+  int invariantFailed = 0;
+  void countingInvariantHandler(const char*, int) {
+    ++invariantFailed;
+  }
+
+  template <typename T>
+  class ContractTransactionTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override {
+      invariantFailed = 0;
+      contract_light::setHandlerFailedInvariant(&countingInvariantHandler);
+    }
+  };
+
+  typedef ::testing::Types<BulkContainer, ThreadLocalBulkContainer> Containers;
+  TYPED_TEST_CASE(ContractTransactionTest, Containers);
+}
+
+TYPED_TEST(ContractTransactionTest, ThatWithoutTransactionEveryCallChecksTheInvariant)
+{
+  TypeParam sut;
+  for (int i = 0; i < 100; ++i) {
+    sut.insert(i);
+  }
+  EXPECT_EQ(100, sut.invariantCalled);
+}
+
+TYPED_TEST(ContractTransactionTest, ThatTheInvariantIsCheckedOnceAtTheEndOfATransaction)
+{
+  TypeParam sut;
+  {
+    CONTRACT_TRANSACTION(sut);
+    for (int i = 0; i < 100; ++i) {
+      sut.insert(i);
+    }
+    EXPECT_EQ(0, sut.invariantCalled);
+  }
+  EXPECT_EQ(1, sut.invariantCalled);
+  EXPECT_EQ(100u, sut.values.size());
+}
+
+TYPED_TEST(ContractTransactionTest, ThatAMemberFunctionCanOpenATransactionOnItself)
+{
+  TypeParam sut;
+  sut.loadAll(std::vector<int>(50, 1));
+  EXPECT_EQ(1, sut.invariantCalled);
+}
+
+TYPED_TEST(ContractTransactionTest, ThatABrokenInvariantIsReportedAtTheEnd)
+{
+  TypeParam sut;
+  {
+    CONTRACT_TRANSACTION(sut);
+    sut.insert(1);
+    sut.broken = true;
+    sut.insert(2);
+    EXPECT_EQ(0, invariantFailed);
+  }
+  EXPECT_EQ(1, invariantFailed);
+}
+
+TYPED_TEST(ContractTransactionTest, ThatTheInvariantIsCheckedOnEntryWhenRequested)
+{
+  TypeParam sut;
+  CONTRACT_LIGHT_SITE(site, contract_light::ContractKind::Invariant, CONTRACT_LIGHT_LEVEL_AUDIT, "invariant()");
+  {
+    auto transaction = contract_light::contract_detail::makeTransaction<true>(sut, site, contract_light::contract_detail::NoSiteMonitor());
+    sut.insert(1);
+    EXPECT_EQ(1, sut.invariantCalled);
+  }
+  EXPECT_EQ(2, sut.invariantCalled);
+}